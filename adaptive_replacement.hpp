@@ -0,0 +1,140 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_ADAPTIVE_REPLACEMENT_HPP
+#define STEP20_ADAPTIVE_REPLACEMENT_HPP
+
+#include "least_recently_used.hpp"
+#include <algorithm>
+#include <utility>
+#include <variant>
+
+namespace step20::adaptive_replacement {
+
+/// Adaptive Replacement Cache (ARC) of Megiddo and Modha.
+
+/// Items seen once (T1) and at least twice (T2) share the capacity.
+/// Ghost lists (B1, B2) remember keys recently evicted from them,
+/// and a miss on a ghost key moves the target size of T1 toward its list,
+/// so the balance between recency and frequency adapts to the workload.
+template <class Key,
+          class T,
+          class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>>
+class cache {
+    template <class V>
+    using list_type =
+        least_recently_used::detail::linked_hash_map<Key, V, Hash, KeyEqual>;
+    using ghost_type = list_type<std::monostate>;
+
+    list_type<T> t1_;
+    list_type<T> t2_;
+    ghost_type b1_;
+    ghost_type b2_;
+    std::size_t capacity_;
+    std::size_t p_ = 0;  ///< target size of T1
+
+    static void demote(list_type<T>& from, ghost_type& to)
+    {
+        auto it = from.begin();
+        to.try_emplace(to.end(), it->first);
+        from.erase(it);
+    }
+
+    /// Evict the least recently used item of T1 or T2 into its ghost list.
+    void replace(bool in_b2)
+    {
+        if (t1_.size() + t2_.size() < capacity_)
+            return;
+        if (t1_.size() && (t1_.size() > p_ || !t2_.size() ||
+                           (in_b2 && t1_.size() == p_)))
+            demote(t1_, b1_);
+        else
+            demote(t2_, b2_);
+    }
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+
+    /// Nothing is stored if capacity is zero.
+    explicit cache(std::size_t capacity) : capacity_(capacity) {}
+
+    cache(cache&&) = default;
+    cache& operator=(cache&&) = default;
+    cache(const cache&) = delete;
+    cache& operator=(const cache&) = delete;
+    virtual ~cache() = default;
+
+    auto size() const { return t1_.size() + t2_.size(); }
+
+    /// Item found in T1 is promoted to T2.
+    /// @return nullptr if key is not found
+    template <class K>
+    const T* find(const K& key)
+    {
+        if (auto it = t2_.find(key); it != t2_.end()) {
+            t2_.transfer(it, t2_.end());
+            return std::addressof(it->second);
+        }
+        auto it = t1_.find(key);
+        if (it == t1_.end())
+            return nullptr;
+        auto pos =
+            t2_.try_emplace(t2_.end(), it->first, std::move(it->second)).first;
+        t1_.erase(it);
+        return std::addressof(pos->second);
+    }
+
+    /// Basic exception guarantee.
+    template <class K, class M>
+    void insert_or_assign(K&& key, M&& val)
+    {
+        if (auto ptr = find(key)) {
+            *const_cast<T*>(ptr) = std::forward<M>(val);
+            return;
+        }
+        if (!capacity_)
+            return;
+        if (auto it = b1_.find(key); it != b1_.end()) {
+            auto delta = std::max<std::size_t>(1, b2_.size() / b1_.size());
+            p_ = std::min(capacity_, p_ + delta);
+            b1_.erase(it);
+            replace(false);
+            t2_.try_emplace(
+                t2_.end(), std::forward<K>(key), std::forward<M>(val));
+            return;
+        }
+        if (auto it = b2_.find(key); it != b2_.end()) {
+            auto delta = std::max<std::size_t>(1, b1_.size() / b2_.size());
+            p_ -= std::min(p_, delta);
+            b2_.erase(it);
+            replace(true);
+            t2_.try_emplace(
+                t2_.end(), std::forward<K>(key), std::forward<M>(val));
+            return;
+        }
+        auto l1 = t1_.size() + b1_.size();
+        if (l1 >= capacity_) {
+            if (t1_.size() < capacity_) {
+                b1_.erase(b1_.begin());
+                replace(false);
+            }
+            else
+                t1_.erase(t1_.begin());
+        }
+        else if (auto total = l1 + t2_.size() + b2_.size();
+                 total >= capacity_) {
+            if (total >= 2 * capacity_)
+                b2_.erase(b2_.begin());
+            replace(false);
+        }
+        t1_.try_emplace(
+            t1_.end(), std::forward<K>(key), std::forward<M>(val));
+    }
+};
+
+}  // namespace step20::adaptive_replacement
+
+#endif  // STEP20_ADAPTIVE_REPLACEMENT_HPP
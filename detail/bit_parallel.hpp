@@ -0,0 +1,214 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_BIT_PARALLEL_HPP
+#define STEP20_BIT_PARALLEL_HPP
+
+#include "../to.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <ranges>
+#include <unordered_map>
+#include <vector>
+
+namespace step20::bit_parallel {
+
+using word_t = uint64_t;
+constexpr std::size_t word_size = std::numeric_limits<word_t>::digits;
+
+/// Match bitmasks of the pattern for each character of the alphabet.
+
+/// It is built once and reused for any number of texts.
+/// Characters are compared with std::hash / std::equal_to.
+template <class Char>
+class pattern {
+    static constexpr bool byte_v = sizeof(Char) == 1;
+    std::size_t size_;
+    std::size_t words_;
+    std::vector<word_t> masks_;  ///< [slot * words_ + word]
+    std::unordered_map<Char, std::size_t> slots_;
+
+    std::size_t slot(Char ch) const
+    {
+        if constexpr (byte_v)
+            return static_cast<unsigned char>(ch);
+        else {
+            auto it = slots_.find(ch);
+            return it == slots_.end() ? 0 : it->second;
+        }
+    }
+
+public:
+    template <std::ranges::input_range R>
+    explicit pattern(const R& r)
+    {
+        auto str = to<std::vector<Char>>(r);
+        size_ = str.size();
+        words_ = (size_ + word_size - 1) / word_size;
+        if constexpr (byte_v)
+            masks_.resize((std::numeric_limits<unsigned char>::max() + 1) *
+                          words_);
+        else
+            masks_.resize(words_);  ///< zero slot for mismatches
+        for (std::size_t i = 0; i < size_; ++i) {
+            if constexpr (!byte_v) {
+                auto [it, success] = slots_.try_emplace(str[i], 0);
+                if (success) {
+                    it->second = masks_.size() / words_;
+                    masks_.resize(masks_.size() + words_);
+                }
+            }
+            masks_[slot(str[i]) * words_ + i / word_size] |= word_t{1}
+                                                             << i % word_size;
+        }
+    }
+
+    std::size_t size() const { return size_; }
+    std::size_t words() const { return words_; }
+    const word_t* operator[](Char ch) const
+    {
+        return masks_.data() + slot(ch) * words_;
+    }
+};
+
+template <std::ranges::input_range R>
+pattern(const R&) -> pattern<std::ranges::range_value_t<R>>;
+
+/// Myers' algorithm with Hyyrö's multi-word extension.
+
+/// Time complexity O(ceil(M/W)*N), where:
+/// M - pattern length, N - text length, W - machine word size.
+/// @return std::nullopt if distance exceeds the limit
+template <class Char, std::ranges::forward_range R>
+std::optional<std::size_t> levenshtein(const pattern<Char>& pat,
+                                       const R& text,
+                                       std::size_t max = SIZE_MAX)
+{
+    auto m = pat.size();
+    auto n = (std::size_t)std::ranges::distance(text);
+    if ((m > n ? m - n : n - m) > max)
+        return std::nullopt;
+    if (m == 0)
+        return n;
+    auto words = pat.words();
+    auto pv = std::vector<word_t>(words, ~word_t{});
+    auto mv = std::vector<word_t>(words);
+    auto top_bit = word_t{1} << (word_size - 1);
+    auto last_bit = word_t{1} << (m - 1) % word_size;
+    auto score = m;
+    auto remain = n;
+    for (auto&& ch : text) {
+        auto eqs = pat[ch];
+        int carry = 1;  ///< horizontal delta of the first row
+        for (std::size_t w = 0; w < words; ++w) {
+            auto eq = eqs[w];
+            auto xv = eq | mv[w];
+            if (carry < 0)
+                eq |= 1;
+            auto xh = (((eq & pv[w]) + pv[w]) ^ pv[w]) | eq;
+            auto ph = mv[w] | ~(xh | pv[w]);
+            auto mh = pv[w] & xh;
+            auto high = w + 1 == words ? last_bit : top_bit;
+            int out = (ph & high) ? 1 : (mh & high) ? -1 : 0;
+            ph <<= 1;
+            mh <<= 1;
+            if (carry < 0)
+                mh |= 1;
+            else if (carry > 0)
+                ph |= 1;
+            pv[w] = mh | ~(xv | ph);
+            mv[w] = ph & xv;
+            carry = out;
+        }
+        score += carry;
+        if (--remain < score && score - remain > max)
+            return std::nullopt;
+    }
+    return score;
+}
+
+/// Bit-vector algorithm of Allison-Dix in Hyyrö's formulation.
+
+/// Time complexity O(ceil(M/W)*N), where:
+/// M - pattern length, N - text length, W - machine word size.
+/// @return std::nullopt if length falls short of the limit
+template <class Char, std::ranges::forward_range R>
+std::optional<std::size_t> lcs_length(const pattern<Char>& pat,
+                                      const R& text,
+                                      std::size_t min = 0)
+{
+    auto m = pat.size();
+    auto n = (std::size_t)std::ranges::distance(text);
+    if (std::min(m, n) < min)
+        return std::nullopt;
+    auto words = pat.words();
+    auto v = std::vector<word_t>(words, ~word_t{});
+    auto length = [&] {
+        std::size_t result = 0;
+        for (auto w : v)
+            result += std::popcount(~w);  ///< excess bits remain set
+        return result;
+    };
+    auto remain = n;
+    for (auto&& ch : text) {
+        auto eqs = pat[ch];
+        word_t carry = 0;
+        for (std::size_t w = 0; w < words; ++w) {
+            auto u = v[w] & eqs[w];
+            auto sum = v[w] + u;
+            auto c = word_t{sum < u};
+            sum += carry;
+            carry = c | word_t{sum < carry};
+            v[w] = sum | (v[w] - u);
+        }
+        if (--remain % word_size == 0 && length() + remain < min)
+            return std::nullopt;
+    }
+    auto result = length();
+    if (result < min)
+        return std::nullopt;
+    return result;
+}
+
+/// Compare the query with each candidate in parallel.
+
+/// Query is preprocessed once for all candidates.
+template <class Metric,
+          std::ranges::input_range R,
+          std::ranges::random_access_range Rs>
+auto one_vs_many(const Metric& metric, const R& query, const Rs& candidates)
+    -> std::vector<std::optional<std::size_t>>
+{
+    auto pat = pattern{query};
+    auto first = std::ranges::begin(candidates);
+    auto result = std::vector<std::optional<std::size_t>>(
+        std::ranges::distance(candidates));
+    parallel_for(result.size(),
+                 [&](std::size_t i) { result[i] = metric(pat, first[i]); });
+    return result;
+}
+
+/// Compare each pair of strings in parallel.
+
+/// @return symmetric N*N matrix in row-major order
+template <class Metric, std::ranges::random_access_range Rs>
+auto all_pairs(const Metric& metric, const Rs& strs)
+    -> std::vector<std::optional<std::size_t>>
+{
+    auto first = std::ranges::begin(strs);
+    std::size_t n = std::ranges::distance(strs);
+    auto result = std::vector<std::optional<std::size_t>>(n * n);
+    parallel_for(n, [&](std::size_t i) {
+        auto pat = pattern{first[i]};
+        for (auto j = i; j < n; ++j)
+            result[i * n + j] = result[j * n + i] = metric(pat, first[j]);
+    });
+    return result;
+}
+
+}  // namespace step20::bit_parallel
+
+#endif  // STEP20_BIT_PARALLEL_HPP
@@ -0,0 +1,65 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_CACHE_OBSERVER_HPP
+#define STEP20_CACHE_OBSERVER_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace step20 {
+
+/// Default observer of caches, it compiles to nothing.
+
+/// Eviction is a removal by the policy (capacity or expiration),
+/// erasure is an explicit removal by the user.
+struct null_observer {
+    void on_hit(const auto&) {}
+    void on_miss(const auto&) {}
+    void on_evict(const auto&, const auto&) {}
+    void on_erase(const auto&, const auto&) {}
+};
+
+/// Hit, miss, eviction and erasure counters.
+
+/// Use std::atomic_size_t to read them without the lock of the cache,
+/// increments are relaxed. Derive to add an eviction callback.
+/// @see sharded_cache::stats to sum them over shards.
+template <class Counter = std::size_t>
+struct statistics {
+    Counter hits{};
+    Counter misses{};
+    Counter evictions{};
+    Counter erasures{};
+
+    void on_hit(const auto&) { increment(hits); }
+    void on_miss(const auto&) { increment(misses); }
+    void on_evict(const auto&, const auto&) { increment(evictions); }
+    void on_erase(const auto&, const auto&) { increment(erasures); }
+
+    double hit_ratio() const
+    {
+        double total = load(hits) + load(misses);
+        return total ? load(hits) / total : 0;
+    }
+
+private:
+    static void increment(Counter& counter)
+    {
+        if constexpr (requires { counter.fetch_add(1); })
+            counter.fetch_add(1, std::memory_order_relaxed);
+        else
+            ++counter;
+    }
+
+    static std::size_t load(const Counter& counter)
+    {
+        if constexpr (requires { counter.load(); })
+            return counter.load(std::memory_order_relaxed);
+        else
+            return counter;
+    }
+};
+
+}  // namespace step20
+
+#endif  // STEP20_CACHE_OBSERVER_HPP
@@ -0,0 +1,80 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_CODEC_HPP
+#define STEP20_CODEC_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <ios>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+namespace step20 {
+
+/// Binary codec of trivially copyable values in the native byte order.
+
+/// Custom codec provides the same encode/decode pair for its type.
+/// Stream failures are reported with std::ios_base::failure.
+template <class T>
+struct codec {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    static void encode(std::ostream& os, const T& val)
+    {
+        if (!os.write(reinterpret_cast<const char*>(std::addressof(val)),
+                      sizeof(T)))
+            throw std::ios_base::failure("codec: write failed");
+    }
+
+    static T decode(std::istream& is)
+    {
+        auto buf = std::array<char, sizeof(T)>{};
+        if (!is.read(buf.data(), buf.size()))
+            throw std::ios_base::failure("codec: unexpected end of stream");
+        return std::bit_cast<T>(buf);
+    }
+};
+
+/// Length-prefixed codec of strings.
+
+/// String grows as its characters arrive, so a corrupt length
+/// does not allocate more memory than the stream holds.
+template <class Char, class Traits, class Allocator>
+struct codec<std::basic_string<Char, Traits, Allocator>> {
+    using string_type = std::basic_string<Char, Traits, Allocator>;
+    static_assert(std::is_trivially_copyable_v<Char>);
+    static constexpr uint64_t chunk = 4096;  ///< characters per read
+
+    static void encode(std::ostream& os, const string_type& str)
+    {
+        codec<uint64_t>::encode(os, str.size());
+        if (!os.write(reinterpret_cast<const char*>(str.data()),
+                      str.size() * sizeof(Char)))
+            throw std::ios_base::failure("codec: write failed");
+    }
+
+    static string_type decode(std::istream& is)
+    {
+        auto size = codec<uint64_t>::decode(is);
+        auto result = string_type{};
+        while (result.size() < size) {
+            auto pos = result.size();
+            auto n = std::min(size - pos, chunk);
+            result.resize(pos + n);
+            if (!is.read(reinterpret_cast<char*>(result.data() + pos),
+                         n * sizeof(Char)))
+                throw std::ios_base::failure(
+                    "codec: unexpected end of stream");
+        }
+        return result;
+    }
+};
+
+}  // namespace step20
+
+#endif  // STEP20_CODEC_HPP
@@ -0,0 +1,82 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_COUNT_MIN_SKETCH_HPP
+#define STEP20_COUNT_MIN_SKETCH_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace step20 {
+
+/// Approximate frequency of hashes in 4-bit counters.
+
+/// Counters are halved after the sample size of additions,
+/// so the history fades and old popularity does not persist.
+class count_min_sketch {
+    static constexpr std::size_t depth = 4;
+    static constexpr std::size_t nibbles = 16;  ///< per word
+    static constexpr uint64_t multipliers[depth] = {0xc3a5c85c97cb3127ull,
+                                                    0xb492b66fbe98f273ull,
+                                                    0x9ae16a3b2f90404full,
+                                                    0xcbf29ce484222325ull};
+    std::vector<uint64_t> table_;  ///< [row * width + column]
+    std::size_t mask_;
+    std::size_t additions_ = 0;
+    std::size_t sample_;
+
+    /// Multiply-xorshift mixer with an odd multiplier of the row,
+    /// so rows stay independent even for the identity std::hash.
+    std::size_t index(uint64_t hash, std::size_t row) const
+    {
+        hash ^= hash >> 32;
+        hash *= multipliers[row];
+        hash ^= hash >> 29;
+        hash *= multipliers[row];
+        hash ^= hash >> 32;
+        return row * (mask_ + 1) + (hash & mask_);
+    }
+
+    unsigned get(std::size_t i) const
+    {
+        return (table_[i / nibbles] >> (i % nibbles * 4)) & 0xf;
+    }
+
+public:
+    /// @param width - expected number of distinct hot items,
+    /// each row gets four counters per item to reduce collisions
+    explicit count_min_sketch(std::size_t width)
+        : mask_(std::bit_ceil(std::max<std::size_t>(width, nibbles)) * 4 - 1)
+        , sample_(10 * std::max<std::size_t>(width, 1))
+    {
+        table_.resize(depth * (mask_ + 1) / nibbles);
+    }
+
+    void add(uint64_t hash)
+    {
+        bool added = false;
+        for (std::size_t row = 0; row < depth; ++row)
+            if (auto i = index(hash, row); get(i) < 0xf) {
+                table_[i / nibbles] += uint64_t{1} << (i % nibbles * 4);
+                added = true;
+            }
+        if (added && ++additions_ == sample_) {
+            for (auto& word : table_)
+                word = (word >> 1) & 0x7777777777777777ull;
+            additions_ /= 2;
+        }
+    }
+
+    unsigned estimate(uint64_t hash) const
+    {
+        auto result = 0xfu;
+        for (std::size_t row = 0; row < depth; ++row)
+            result = std::min(result, get(index(hash, row)));
+        return result;
+    }
+};
+
+}  // namespace step20
+
+#endif  // STEP20_COUNT_MIN_SKETCH_HPP
@@ -0,0 +1,176 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_FILE_VIEW_HPP
+#define STEP20_FILE_VIEW_HPP
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace step20 {
+
+/// Read-only memory-mapped file.
+
+/// Content is paged in on demand, nothing is copied.
+/// Pipes and devices can not be mapped, they are read into owned storage.
+class file_view {
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::unique_ptr<char[]> owned_;  ///< content of a file that is not mapped
+
+    template <class Read>
+    void read_all(const Read& read)
+    {
+        auto buf = std::string{};
+        for (std::size_t n = 1; n;) {
+            auto size = buf.size();
+            buf.resize(size + 65536);
+            n = read(buf.data() + size, buf.size() - size);
+            buf.resize(size + n);
+        }
+        owned_ = std::make_unique<char[]>(buf.size());
+        std::ranges::copy(buf, owned_.get());
+        data_ = owned_.get();
+        size_ = buf.size();
+    }
+
+public:
+    using value_type = char;
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    const char* begin() const { return data_; }
+    const char* end() const { return data_ + size_; }
+    operator std::string_view() const { return {data_, size_}; }
+    file_view() = default;
+
+    file_view(file_view&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr))
+        , size_(std::exchange(other.size_, 0))
+        , owned_(std::move(other.owned_))
+    {
+    }
+
+    file_view& operator=(file_view&& other) noexcept
+    {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(owned_, other.owned_);
+        return *this;
+    }
+
+#if defined(_WIN32)
+    explicit file_view(const char* file_name)
+    {
+        auto fail = [&] {
+            throw std::system_error(
+                (int)GetLastError(), std::system_category(), file_name);
+        };
+        auto file = CreateFileA(file_name,
+                                GENERIC_READ,
+                                FILE_SHARE_READ,
+                                nullptr,
+                                OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL,
+                                nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            fail();
+        auto close_file = std::unique_ptr<void, decltype(&CloseHandle)>(
+            file, &CloseHandle);
+        if (GetFileType(file) != FILE_TYPE_DISK) {
+            read_all([&](char* ptr, std::size_t size) {
+                auto n = DWORD{};
+                if (!ReadFile(file, ptr, (DWORD)size, &n, nullptr) &&
+                    GetLastError() != ERROR_BROKEN_PIPE)
+                    fail();
+                return std::size_t{n};
+            });
+            return;
+        }
+        auto size = LARGE_INTEGER{};
+        if (!GetFileSizeEx(file, &size))
+            fail();
+        if (size.QuadPart == 0)
+            return;
+        auto mapping =
+            CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping)
+            fail();
+        auto close_mapping = std::unique_ptr<void, decltype(&CloseHandle)>(
+            mapping, &CloseHandle);
+        auto ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!ptr)
+            fail();
+        data_ = static_cast<const char*>(ptr);
+        size_ = static_cast<std::size_t>(size.QuadPart);
+    }
+
+    ~file_view()
+    {
+        if (data_ && !owned_)
+            UnmapViewOfFile(data_);
+    }
+#else
+    explicit file_view(const char* file_name)
+    {
+        auto fail = [&] {
+            throw std::system_error(errno, std::generic_category(), file_name);
+        };
+        int fd = ::open(file_name, O_RDONLY);
+        if (fd == -1)
+            fail();
+        auto close_file = std::unique_ptr<int, void (*)(int*)>(
+            &fd, [](int* ptr) { ::close(*ptr); });
+        struct stat st {};
+        if (::fstat(fd, &st) == -1)
+            fail();
+        if (!S_ISREG(st.st_mode)) {
+            read_all([&](char* ptr, std::size_t size) {
+                auto n = ::read(fd, ptr, size);
+                while (n == -1 && errno == EINTR)
+                    n = ::read(fd, ptr, size);
+                if (n == -1)
+                    fail();
+                return std::size_t(n);
+            });
+            return;
+        }
+        if (st.st_size == 0)
+            return;
+        auto ptr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED)
+            fail();
+        ::madvise(ptr, st.st_size, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(ptr);
+        size_ = static_cast<std::size_t>(st.st_size);
+    }
+
+    ~file_view()
+    {
+        if (data_ && !owned_)
+            ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+};
+
+}  // namespace step20
+
+#endif  // STEP20_FILE_VIEW_HPP
@@ -0,0 +1,161 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_MYERS_HPP
+#define STEP20_MYERS_HPP
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+namespace step20::myers {
+
+template <std::random_access_iterator I1, std::random_access_iterator I2>
+using hunk_t = std::pair<std::ranges::subrange<I1>, std::ranges::subrange<I2>>;
+
+/// Merges adjacent hunks that are produced by different recursion branches.
+template <std::random_access_iterator I1,
+          std::random_access_iterator I2,
+          std::weakly_incrementable O>
+struct hunk_writer {
+    O result;
+    std::optional<hunk_t<I1, I2>> pending;
+
+    void write(I1 first1, I1 last1, I2 first2, I2 last2)
+    {
+        if (first1 == last1 && first2 == last2)
+            return;
+        if (pending && pending->first.end() == first1 &&
+            pending->second.end() == first2) {
+            pending->first = {pending->first.begin(), last1};
+            pending->second = {pending->second.begin(), last2};
+            return;
+        }
+        flush();
+        pending.emplace(std::ranges::subrange{first1, last1},
+                        std::ranges::subrange{first2, last2});
+    }
+
+    O flush()
+    {
+        if (pending)
+            *result++ = *std::exchange(pending, std::nullopt);
+        return result;
+    }
+};
+
+/// Find a point on the shortest edit path that divides it in half.
+
+/// Forward and reverse paths are extended simultaneously until they overlap.
+/// @return std::nullopt if sequences have nothing in common
+template <class Equal,
+          std::random_access_iterator I1,
+          std::random_access_iterator I2>
+auto bisect(const Equal& eq, I1 first1, I1 last1, I2 first2, I2 last2)
+    -> std::optional<std::pair<I1, I2>>
+{
+    using diff_t = std::ptrdiff_t;
+    diff_t size1 = last1 - first1;
+    diff_t size2 = last2 - first2;
+    diff_t max_d = (size1 + size2 + 1) / 2;
+    diff_t offset = max_d + 1;
+    diff_t delta = size1 - size2;
+    bool front = delta % 2 != 0;
+    auto fwd = std::vector<diff_t>(2 * offset + 1, -1);
+    auto rev = std::vector<diff_t>(2 * offset + 1, -1);
+    fwd[offset + 1] = rev[offset + 1] = 0;
+    diff_t fwd_start = 0, fwd_end = 0, rev_start = 0, rev_end = 0;
+    for (diff_t d = 0; d < max_d; ++d) {
+        for (diff_t k = -d + fwd_start; k <= d - fwd_end; k += 2) {
+            auto x = k == -d || (k != d && fwd[offset + k - 1] <
+                                               fwd[offset + k + 1])
+                         ? fwd[offset + k + 1]
+                         : fwd[offset + k - 1] + 1;
+            auto y = x - k;
+            while (x < size1 && y < size2 && eq(first1[x], first2[y]))
+                ++x, ++y;
+            fwd[offset + k] = x;
+            if (x > size1)
+                fwd_end += 2;
+            else if (y > size2)
+                fwd_start += 2;
+            else if (front) {
+                auto i = offset + delta - k;
+                if (i >= 0 && i < (diff_t)rev.size() && rev[i] != -1 &&
+                    x >= size1 - rev[i])
+                    return std::pair{first1 + x, first2 + y};
+            }
+        }
+        for (diff_t k = -d + rev_start; k <= d - rev_end; k += 2) {
+            auto x = k == -d || (k != d && rev[offset + k - 1] <
+                                               rev[offset + k + 1])
+                         ? rev[offset + k + 1]
+                         : rev[offset + k - 1] + 1;
+            auto y = x - k;
+            while (x < size1 && y < size2 &&
+                   eq(first1[size1 - x - 1], first2[size2 - y - 1]))
+                ++x, ++y;
+            rev[offset + k] = x;
+            if (x > size1)
+                rev_end += 2;
+            else if (y > size2)
+                rev_start += 2;
+            else if (!front) {
+                auto i = offset + delta - k;
+                if (i >= 0 && i < (diff_t)fwd.size() && fwd[i] != -1 &&
+                    fwd[i] >= size1 - x)
+                    return std::pair{first1 + fwd[i],
+                                     first2 + (fwd[i] - (i - offset))};
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+template <class Equal,
+          std::random_access_iterator I1,
+          std::random_access_iterator I2,
+          class Writer>
+void compare(const Equal& eq,
+             I1 first1,
+             I1 last1,
+             I2 first2,
+             I2 last2,
+             Writer& writer)
+{
+    std::tie(first1, first2) = std::mismatch(first1, last1, first2, last2, eq);
+    auto tail = std::mismatch(std::reverse_iterator{last1},
+                              std::reverse_iterator{first1},
+                              std::reverse_iterator{last2},
+                              std::reverse_iterator{first2},
+                              eq);
+    last1 = tail.first.base();
+    last2 = tail.second.base();
+    if (first1 == last1 || first2 == last2)
+        return writer.write(first1, last1, first2, last2);
+    auto mid = bisect(eq, first1, last1, first2, last2);
+    if (!mid)
+        return writer.write(first1, last1, first2, last2);
+    compare(eq, first1, mid->first, first2, mid->second, writer);
+    compare(eq, mid->first, last1, mid->second, last2, writer);
+}
+
+/// Write the ranges of both sequences that are out of the common subsequence.
+
+/// Output is a sequence of non-adjacent hunks in ascending order.
+template <class Equal,
+          std::random_access_iterator I1,
+          std::random_access_iterator I2,
+          std::weakly_incrementable O>
+O trace(const Equal& eq, I1 first1, I1 last1, I2 first2, I2 last2, O result)
+{
+    auto writer = hunk_writer<I1, I2, O>{result, std::nullopt};
+    compare(eq, first1, last1, first2, last2, writer);
+    return writer.flush();
+}
+
+}  // namespace step20::myers
+
+#endif  // STEP20_MYERS_HPP
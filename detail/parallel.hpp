@@ -0,0 +1,50 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_PARALLEL_HPP
+#define STEP20_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace step20 {
+
+/// Call fn(i) for each i in [0, n) on all hardware threads.
+
+/// Indices are handed out dynamically, so uneven tasks are balanced.
+/// The first exception is rethrown after all threads are joined.
+template <class F>
+void parallel_for(std::size_t n, F fn)
+{
+    auto next = std::atomic_size_t{};
+    auto error = std::exception_ptr{};
+    auto guard = std::mutex{};
+    auto work = [&] {
+        for (std::size_t i; (i = next++) < n;)
+            try {
+                fn(i);
+            }
+            catch (...) {
+                auto lock = std::lock_guard{guard};
+                if (!error)
+                    error = std::current_exception();
+                next = n;
+            }
+    };
+    {
+        auto threads = std::vector<std::jthread>{};
+        auto hw = std::max(1u, std::thread::hardware_concurrency());
+        for (std::size_t i = 1; i < std::min<std::size_t>(n, hw); ++i)
+            threads.emplace_back(work);
+        work();
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+}  // namespace step20
+
+#endif  // STEP20_PARALLEL_HPP
@@ -0,0 +1,193 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_TIMER_WHEEL_HPP
+#define STEP20_TIMER_WHEEL_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace step20 {
+
+/// Hierarchical timing wheel with 64 slots per level.
+
+/// A timer is scheduled in O(1) to the level of the highest 6-bit digit
+/// where its deadline differs from the current time.
+/// Slots are cascaded to lower levels when the time reaches them,
+/// and ranges of empty slots are skipped using occupancy bitmaps.
+/// Timers are nodes of intrusive lists, so their handles stay valid
+/// while cascading and they are cancelled or rescheduled in O(1).
+template <class T>
+class timer_wheel {
+    static constexpr unsigned bits = 6;
+    static constexpr unsigned slots = 1u << bits;
+    static constexpr unsigned levels = (64 + bits - 1) / bits;
+    static constexpr std::size_t none = SIZE_MAX;
+    static constexpr std::size_t firing = levels * slots;  ///< list of advance
+
+    struct node_type {
+        uint64_t deadline;
+        T val;
+        std::size_t list, prev, next;
+    };
+
+    std::vector<node_type> nodes_;
+    std::size_t free_ = none;  ///< list of released nodes
+    std::array<std::size_t, levels * slots + 1> heads_;
+    std::array<uint64_t, levels> occupied_{};
+    uint64_t time_;  ///< timers before this time are fired
+    std::size_t size_ = 0;
+
+    static unsigned index(uint64_t time, unsigned level)
+    {
+        return (time >> (level * bits)) & (slots - 1);
+    }
+
+    void link(std::size_t i, std::size_t list)
+    {
+        auto& node = nodes_[i];
+        node.list = list;
+        node.prev = none;
+        node.next = heads_[list];
+        if (node.next != none)
+            nodes_[node.next].prev = i;
+        heads_[list] = i;
+    }
+
+    void unlink(std::size_t i)
+    {
+        auto& node = nodes_[i];
+        (node.prev == none ? heads_[node.list] : nodes_[node.prev].next) =
+            node.next;
+        if (node.next != none)
+            nodes_[node.next].prev = node.prev;
+        if (node.list < firing && heads_[node.list] == none)
+            occupied_[node.list / slots] &= ~(uint64_t{1} << node.list % slots);
+    }
+
+    void place(std::size_t i)
+    {
+        auto& deadline = nodes_[i].deadline;
+        deadline = std::max(deadline, time_);
+        auto level = (unsigned)std::bit_width(deadline ^ time_);
+        level = level ? (level - 1) / bits : 0;
+        auto slot = index(deadline, level);
+        link(i, level * slots + slot);
+        occupied_[level] |= uint64_t{1} << slot;
+    }
+
+    void release(std::size_t i)
+    {
+        nodes_[i].list = none;
+        nodes_[i].next = free_;
+        free_ = i;
+        --size_;
+    }
+
+    void cascade(unsigned level, unsigned slot)
+    {
+        if (!(occupied_[level] & (uint64_t{1} << slot)))
+            return;
+        occupied_[level] &= ~(uint64_t{1} << slot);
+        auto i = std::exchange(heads_[level * slots + slot], none);
+        while (i != none)
+            place(std::exchange(i, nodes_[i].next));
+    }
+
+    /// @return the start of the earliest occupied slot or limit
+    uint64_t next(uint64_t time, uint64_t limit) const
+    {
+        for (unsigned level = 1; level < levels; ++level) {
+            auto shift = level * bits;
+            auto mask = occupied_[level] & (~uint64_t{} << index(time, level));
+            if (!mask)
+                continue;
+            auto base = shift + bits < 64 ? time >> (shift + bits)
+                                                << (shift + bits)
+                                          : 0;
+            auto start = base | ((uint64_t)std::countr_zero(mask) << shift);
+            limit = std::min(limit, std::max(start, time));
+        }
+        return limit;
+    }
+
+public:
+    using handle = std::size_t;
+
+    explicit timer_wheel(uint64_t now = 0) : time_(now) { heads_.fill(none); }
+
+    auto size() const { return size_; }
+    const T& operator[](handle timer) const { return nodes_[timer].val; }
+
+    /// Overdue timer fires on the next advance beyond the current time.
+    /// @return handle that is valid until the timer fires or is cancelled
+    handle schedule(uint64_t deadline, T val)
+    {
+        auto i = free_;
+        if (i == none) {
+            i = nodes_.size();
+            nodes_.push_back({deadline, std::move(val), none, none, none});
+        }
+        else {
+            free_ = nodes_[i].next;
+            nodes_[i].deadline = deadline;
+            nodes_[i].val = std::move(val);
+        }
+        place(i);
+        ++size_;
+        return i;
+    }
+
+    void reschedule(handle timer, uint64_t deadline)
+    {
+        unlink(timer);
+        nodes_[timer].deadline = deadline;
+        place(timer);
+    }
+
+    void cancel(handle timer)
+    {
+        unlink(timer);
+        release(timer);
+    }
+
+    /// Call fn(val) for each timer with deadline up to now.
+    /// Function may schedule and cancel other timers.
+    template <class F>
+    void advance(uint64_t now, F fn)
+    {
+        while (time_ <= now) {
+            for (auto level = levels - 1; level > 0; --level)
+                cascade(level, index(time_, level));
+            auto last = std::min(now, time_ | (slots - 1));
+            auto mask = occupied_[0] & (~uint64_t{} << index(time_, 0)) &
+                        (~uint64_t{} >> (slots - 1 - index(last, 0)));
+            for (; mask; mask &= mask - 1) {
+                auto slot = std::countr_zero(mask);
+                occupied_[0] &= ~(uint64_t{1} << slot);
+                heads_[firing] = std::exchange(heads_[slot], none);
+                for (auto i = heads_[firing]; i != none; i = nodes_[i].next)
+                    nodes_[i].list = firing;
+                while (heads_[firing] != none) {
+                    auto i = heads_[firing];
+                    unlink(i);
+                    auto val = std::move(nodes_[i].val);
+                    release(i);
+                    fn(std::move(val));
+                }
+            }
+            if (last == now) {
+                time_ = now + 1;
+                break;
+            }
+            time_ = next(last + 1, now + 1);
+        }
+    }
+};
+
+}  // namespace step20
+
+#endif  // STEP20_TIMER_WHEEL_HPP
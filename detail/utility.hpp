@@ -5,10 +5,15 @@
 
 #include <array>
 #include <concepts>
+#include <functional>
 #include <iterator>
 #include <limits>
 #include <ranges>
+#include <type_traits>
 #include <vector>
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#endif
 
 namespace step20 {
 
@@ -51,6 +56,86 @@ auto try_reverse(std::ranges::borrowed_range auto&& range)
         return range | std::views::all;
 }
 
+/// Pointer to the key is dereferenced, other arguments are passed through.
+template <class Key, class T>
+const auto& dereference(const T& val)
+{
+    if constexpr (std::same_as<T, const Key*>)
+        return *val;
+    else
+        return val;
+}
+
+/// Transparent hash for maps that refer to keys stored elsewhere.
+template <class Key, class Hash>
+struct indirect_hash {
+    using is_transparent = void;
+
+    template <class K>
+    std::size_t operator()(const K& key) const
+    {
+        return Hash{}(dereference<Key>(key));
+    }
+};
+
+/// Transparent equality for maps that refer to keys stored elsewhere.
+template <class Key, class KeyEqual>
+struct indirect_equal {
+    using is_transparent = void;
+
+    template <class K1, class K2>
+    bool operator()(const K1& lhs, const K2& rhs) const
+    {
+        return KeyEqual{}(dereference<Key>(lhs), dereference<Key>(rhs));
+    }
+};
+
+/// Default weigher of caches, capacity counts items.
+struct unit_weigher {
+    std::size_t operator()(const auto&, const auto&) const { return 1; }
+};
+
+/// Converts to the result of the function, to construct values in place.
+template <class F>
+struct deferred {
+    F& fn;
+    operator std::invoke_result_t<F&>() const { return fn(); }
+};
+
+struct deferred_probe {};
+
+/// Type that is constructible from anything (e.g. std::any)
+/// would capture deferred itself instead of converting it.
+template <class T>
+constexpr bool deferrable_v = !std::constructible_from<T, deferred_probe>;
+
+/// @return deferred if T is built in place, otherwise the result of fn
+template <class T, class F>
+decltype(auto) in_place_arg(F& fn)
+{
+    if constexpr (deferrable_v<T>)
+        return deferred<F>{fn};
+    else
+        return fn();
+}
+
+/// Elements of the range are moved from if it owns them and is an rvalue.
+
+/// Views are not owning, their elements are copied.
+template <class R>
+constexpr bool movable_elements_v = !std::is_lvalue_reference_v<R> &&
+                                    !std::ranges::view<std::remove_cvref_t<R>>;
+
+/// Hint to load the cache line in advance.
+inline void prefetch(const void* ptr)
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(ptr);
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_prefetch(static_cast<const char*>(ptr), _MM_HINT_T0);
+#endif
+}
+
 template <class Container>
 class emplace_iterator {
     Container* c_;
@@ -3,12 +3,31 @@
 #ifndef STEP20_EDIT_DISTANCE_HPP
 #define STEP20_EDIT_DISTANCE_HPP
 
+#include "detail/bit_parallel.hpp"
 #include "detail/hirschberg.hpp"
 #include "detail/utility.hpp"
 #include <cstdint>
 #include <optional>
 
 namespace step20::edit_distance {
+
+/// Edit operations in terms of the extended CIGAR format.
+enum class operation : char {
+    match = '=',
+    mismatch = 'X',
+    insertion = 'I',  ///< element of the second sequence only
+    deletion = 'D',   ///< element of the first sequence only
+};
+
+/// Run of the same edit operations.
+struct run_type {
+    operation op;
+    std::size_t length;
+    std::size_t pos1;  ///< offset in the first sequence
+    std::size_t pos2;  ///< offset in the second sequence
+    friend bool operator==(const run_type&, const run_type&) = default;
+};
+
 namespace detail {
 
 template <class Equal>
@@ -60,6 +79,83 @@ struct table {
     }
 };
 
+template <class Equal,
+          std::random_access_iterator I1,
+          std::random_access_iterator I2>
+struct run_table : table<Equal> {
+    I1 origin1;
+    I2 origin2;
+
+    template <bool transposed,
+              std::random_access_iterator It1,
+              std::random_access_iterator It2,
+              std::weakly_incrementable O>
+    O trace_col(It1 first1, It1 last1, It2 first2, It2 last2, O result) const
+    {
+        auto make_run = [&](operation op) {
+            if constexpr (transposed)
+                return run_type{op,
+                                1,
+                                (std::size_t)(first2 - origin1),
+                                (std::size_t)(first1 - origin2)};
+            else
+                return run_type{op,
+                                1,
+                                (std::size_t)(first1 - origin1),
+                                (std::size_t)(first2 - origin2)};
+        };
+        while (first1 != last1) {
+            if (first2 == last2 ||
+                (first1 + 1 != last1 && !this->eq(*first1, *first2))) {
+                *result++ = make_run(transposed ? operation::insertion
+                                                : operation::deletion);
+                ++first1;
+            }
+            else {
+                *result++ = make_run(this->eq(*first1, *first2)
+                                         ? operation::match
+                                         : operation::mismatch);
+                ++first1;
+                ++first2;
+            }
+        }
+        return result;
+    }
+};
+
+/// Merges successive runs of the same operation, copies share the state.
+template <std::weakly_incrementable O>
+class run_iterator {
+    O* result_;
+    std::optional<run_type>* last_;
+
+public:
+    using iterator_category = std::output_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = void;
+    using reference = void;
+    run_iterator(O& result, std::optional<run_type>& last)
+        : result_(std::addressof(result)), last_(std::addressof(last))
+    {
+    }
+    run_iterator& operator*() { return *this; }
+    run_iterator& operator++() { return *this; }
+    run_iterator operator++(int) { return *this; }
+
+    run_iterator& operator=(const run_type& run)
+    {
+        auto& last = *last_;
+        if (last && last->op == run.op)
+            last->length += run.length;
+        else {
+            if (last)
+                *(*result_)++ = *last;
+            last = run;
+        }
+        return *this;
+    }
+};
+
 }  // namespace detail
 
 /// Find the optimal sequence alignment between two strings.
@@ -84,6 +180,79 @@ O zip(const R1& r1, const R2& r2, O result, const Equal& eq = {})
                              result);
 }
 
+/// Find the optimal sequence alignment as runs of edit operations.
+
+/// Writes run_type for each run instead of a pair for each position.
+/// @see zip
+template <std::ranges::random_access_range R1,
+          std::ranges::random_access_range R2,
+          std::weakly_incrementable O,
+          class Equal = std::equal_to<>>
+O cigar(const R1& r1, const R2& r2, O result, const Equal& eq = {})
+{
+    auto first1 = std::ranges::begin(r1);
+    auto first2 = std::ranges::begin(r2);
+    auto last = std::optional<run_type>{};
+    hirschberg::trace(
+        detail::run_table<Equal, decltype(first1), decltype(first2)>{
+            {eq}, first1, first2},
+        first1,
+        std::ranges::end(r1),
+        first2,
+        std::ranges::end(r2),
+        detail::run_iterator<O>{result, last});
+    if (last)
+        *result++ = *last;
+    return result;
+}
+
+/// Find the Levenshtein distance between two strings.
+
+/// Bit-parallel algorithm, characters are compared with std::equal_to.
+/// Time complexity O(ceil(N/W)*M), space complexity O(N+K), where:
+/// N = std::ranges::distance(r1), M = std::ranges::distance(r2),
+/// W - machine word size, K - alphabet size.
+template <std::ranges::forward_range R1, std::ranges::forward_range R2>
+std::size_t distance(const R1& r1, const R2& r2)
+{
+    return *bit_parallel::levenshtein(bit_parallel::pattern{r1}, r2);
+}
+
+/// Find the Levenshtein distances between the query and each candidate.
+
+/// Candidates are processed in parallel, the query is preprocessed once.
+/// @return std::nullopt for distances greater than max_distance
+template <std::ranges::forward_range R, std::ranges::random_access_range Rs>
+auto distances(const R& query,
+               const Rs& candidates,
+               std::size_t max_distance = SIZE_MAX)
+    -> std::vector<std::optional<std::size_t>>
+{
+    return bit_parallel::one_vs_many(
+        [=](const auto& pat, const auto& str) {
+            return bit_parallel::levenshtein(pat, str, max_distance);
+        },
+        query,
+        candidates);
+}
+
+/// Find the Levenshtein distances between each pair of strings.
+
+/// Rows are processed in parallel.
+/// @return symmetric N*N matrix in row-major order, where:
+/// N = std::ranges::distance(strs);
+/// std::nullopt for distances greater than max_distance
+template <std::ranges::random_access_range Rs>
+auto distances(const Rs& strs, std::size_t max_distance = SIZE_MAX)
+    -> std::vector<std::optional<std::size_t>>
+{
+    return bit_parallel::all_pairs(
+        [=](const auto& pat, const auto& str) {
+            return bit_parallel::levenshtein(pat, str, max_distance);
+        },
+        strs);
+}
+
 }  // namespace step20::edit_distance
 
 #endif  // STEP20_EDIT_DISTANCE_HPP
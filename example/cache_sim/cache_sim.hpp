@@ -0,0 +1,162 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_EXAMPLE_CACHE_SIM_HPP
+#define STEP20_EXAMPLE_CACHE_SIM_HPP
+
+#include "../../adaptive_replacement.hpp"
+#include "../../detail/parallel.hpp"
+#include "../../least_frequently_used.hpp"
+#include "../../least_recently_used.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <ranges>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace step20::cache_sim {
+
+using key_type = uint64_t;
+using trace_t = std::vector<key_type>;
+
+/// Bytes allocated by the current thread.
+
+/// The program maintains them in its replacement of operator new/delete,
+/// otherwise peak memory is reported as zero.
+inline thread_local std::ptrdiff_t allocated = 0;
+inline thread_local std::ptrdiff_t peak_allocated = 0;
+
+/// Text trace has a key per line, equal lines share the same identifier.
+inline trace_t parse_text(std::string_view txt)
+{
+    auto result = trace_t{};
+    auto dict = std::unordered_map<std::string_view, key_type>{};
+    for (auto&& line : txt | std::views::split('\n')) {
+        auto key = std::string_view(std::addressof(*line.begin()),
+                                    std::ranges::distance(line));
+        if (key.ends_with('\r'))
+            key.remove_suffix(1);
+        if (!key.empty())
+            result.push_back(dict.try_emplace(key, dict.size()).first->second);
+    }
+    return result;
+}
+
+/// Binary trace is an array of 64-bit keys in the native byte order.
+inline trace_t parse_binary(std::string_view bin)
+{
+    auto result = trace_t(bin.size() / sizeof(key_type));
+    std::memcpy(result.data(), bin.data(), result.size() * sizeof(key_type));
+    return result;
+}
+
+/// Zipf-like trace with a scan of unique keys in every tenth hundred.
+
+/// It is reproducible for the seed on any platform.
+/// @param keys - number of distinct popular keys
+inline trace_t generate(std::size_t size, std::size_t keys, uint64_t seed = 1)
+{
+    auto cdf = std::vector<double>(keys);
+    double sum = 0;
+    for (std::size_t i = 0; i < keys; ++i)
+        cdf[i] = sum += 1. / (i + 1);
+    auto gen = std::mt19937_64{seed};
+    auto result = trace_t(size);
+    auto scanned = key_type(keys);
+    for (std::size_t i = 0; i < size; ++i)
+        if (i / 100 % 10 == 9)
+            result[i] = scanned++;
+        else {
+            auto u = (gen() >> 11) * 0x1p-53 * sum;  ///< uniform in [0, sum)
+            auto it = std::ranges::upper_bound(cdf, u);
+            result[i] = std::min<key_type>(it - cdf.begin(), keys - 1);
+        }
+    return result;
+}
+
+struct report {
+    std::string_view policy;
+    std::size_t capacity;
+    std::size_t hits;
+    std::size_t ops;
+    double seconds;
+    std::ptrdiff_t peak_bytes;
+
+    double hit_ratio() const { return ops ? double(hits) / ops : 0; }
+    double ops_per_sec() const { return seconds > 0 ? ops / seconds : 0; }
+};
+
+/// Look up each key of the trace and insert it on a miss.
+template <class Cache>
+report replay(std::string_view policy, const trace_t& trace, std::size_t cap)
+{
+    auto result = report{policy, cap, 0, trace.size(), 0, 0};
+    auto base = allocated;
+    peak_allocated = base;
+    auto start = std::chrono::steady_clock::now();
+    {
+        auto cache = Cache(cap);
+        for (auto key : trace)
+            if (cache.find(key))
+                ++result.hits;
+            else
+                cache.insert_or_assign(key, key);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(stop - start).count();
+    result.peak_bytes = peak_allocated - base;
+    return result;
+}
+
+using replay_fn = report (*)(std::string_view, const trace_t&, std::size_t);
+
+namespace arc = adaptive_replacement;
+namespace lfu = least_frequently_used;
+namespace lru = least_recently_used;
+
+inline const auto policies =
+    std::vector<std::pair<std::string_view, replay_fn>>{
+    {"ARC", replay<arc::cache<key_type, key_type>>},
+    {"CLOCK", replay<lru::clock_cache<key_type, key_type>>},
+    {"LFU", replay<lfu::cache<key_type, key_type>>},
+    {"LRU", replay<lru::cache<key_type, key_type>>},
+    {"LRU(flat)", replay<lru::flat_cache<key_type, key_type>>},
+    {"W-TinyLFU", replay<lfu::tiny_cache<key_type, key_type>>},
+};
+
+/// Replay the trace against each policy at each capacity in parallel.
+
+/// Throughput is measured under contention for the cores and memory,
+/// so it serves to compare the policies rather than as an absolute.
+inline std::vector<report> sweep(const trace_t& trace,
+                                 const std::vector<std::size_t>& capacities)
+{
+    auto n = capacities.size();
+    auto result = std::vector<report>(policies.size() * n);
+    parallel_for(result.size(), [&](std::size_t i) {
+        auto& [name, fn] = policies[i / n];
+        result[i] = fn(name, trace, capacities[i % n]);
+    });
+    return result;
+}
+
+inline void dump(const std::vector<report>& reports, std::ostream& os)
+{
+    os << std::left << std::setw(12) << "policy" << std::right
+       << std::setw(10) << "capacity" << std::setw(10) << "hit ratio"
+       << std::setw(14) << "ops/sec" << std::setw(12) << "peak KiB\n";
+    for (auto& rep : reports)
+        os << std::left << std::setw(12) << rep.policy << std::right
+           << std::setw(10) << rep.capacity << std::setw(10) << std::fixed
+           << std::setprecision(4) << rep.hit_ratio() << std::setw(14)
+           << std::setprecision(0) << rep.ops_per_sec() << std::setw(11)
+           << rep.peak_bytes / 1024 << "\n";
+}
+
+}  // namespace step20::cache_sim
+
+#endif  // STEP20_EXAMPLE_CACHE_SIM_HPP
@@ -0,0 +1,3 @@
+${1:-g++} -I ../../.. -std=c++20 -Wall -O2 -o result main.cpp
+./result zipf 10 100 1000
+rm ./result
@@ -0,0 +1,72 @@
+// Andrew Naplavkov
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <step20/detail/file_view.hpp>
+#include <step20/example/cache_sim/cache_sim.hpp>
+#include <string>
+
+namespace {
+
+/// Block size is stored in front of the block, keeping it aligned.
+constexpr std::size_t header = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+}  // namespace
+
+/// Array and nothrow forms call these ones by default.
+void* operator new(std::size_t size)
+{
+    using namespace step20::cache_sim;
+    auto block = static_cast<std::byte*>(std::malloc(header + size));
+    if (!block)
+        throw std::bad_alloc{};
+    ::new (block) std::size_t{size};
+    allocated += size;
+    peak_allocated = std::max(peak_allocated, allocated);
+    return block + header;
+}
+
+/// Not inlined, so GCC does not take free() for a mismatch
+/// with the new-expression of the caller.
+[[gnu::noinline]] void operator delete(void* ptr) noexcept
+{
+    if (!ptr)
+        return;
+    auto block = static_cast<std::byte*>(ptr) - header;
+    step20::cache_sim::allocated -= *std::launder(
+        reinterpret_cast<std::size_t*>(block));
+    std::free(block);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    ::operator delete(ptr);
+}
+
+/// Usage: main <trace> <capacity>...
+/// Trace "zipf" is generated with a fixed seed.
+/// Trace with the ".bin" extension is binary, otherwise it is text.
+int main(int argc, char* argv[])
+{
+    using namespace step20;
+    if (argc < 2) {
+        std::cerr << "Usage: cache_sim <trace> <capacity>...\n";
+        return EXIT_FAILURE;
+    }
+    auto path = std::string_view{argv[1]};
+    auto trace = cache_sim::trace_t{};
+    if (path == "zipf")
+        trace = cache_sim::generate(20000, 4000);
+    else if (auto file = file_view(argv[1]); path.ends_with(".bin"))
+        trace = cache_sim::parse_binary(file);
+    else
+        trace = cache_sim::parse_text(file);
+    auto capacities = std::vector<std::size_t>{};
+    for (int i = 2; i < argc; ++i)
+        capacities.push_back(std::stoull(argv[i]));
+    std::cout << trace.size() << " keys\n";
+    cache_sim::dump(cache_sim::sweep(trace, capacities), std::cout);
+}
@@ -3,44 +3,139 @@
 #ifndef STEP20_EXAMPLE_DIFF_HPP
 #define STEP20_EXAMPLE_DIFF_HPP
 
-#include "../../generator.hpp"
 #include "../../longest_common_subsequence.hpp"
 #include "../../to.hpp"
 #include <ostream>
 #include <string_view>
+#include <tuple>
+#include <unordered_map>
 
 namespace step20::diff {
 namespace detail {
 
 using lines_t = std::vector<std::string_view>;
-using range_t = std::ranges::subrange<lines_t::iterator>;
-using pair_t = std::pair<range_t, range_t>;
+using range_t = std::ranges::subrange<lines_t::const_iterator>;
+using hunk_t = std::pair<range_t, range_t>;
+using ids_t = std::vector<std::size_t>;
 
+/// Mapped files are not translated, so "\r\n" is also a line break.
 inline lines_t to_lines(std::string_view txt)
 {
     return to<lines_t>(
         txt | std::views::split('\n') | std::views::transform([](auto&& line) {
-            return std::string_view(std::addressof(*line.begin()),
-                                    std::ranges::distance(line));
+            auto result = std::string_view(std::addressof(*line.begin()),
+                                           std::ranges::distance(line));
+            if (result.ends_with('\r'))
+                result.remove_suffix(1);
+            return result;
         }));
 }
 
-inline pair_t split(range_t r, std::string_view pattern)
+/// Replace lines with dense identifiers, equal lines share the same one.
+
+/// @return identifiers of both ranges and the number of distinct ones
+inline std::tuple<ids_t, ids_t, std::size_t> intern(range_t r1, range_t r2)
+{
+    auto dict = std::unordered_map<std::string_view, std::size_t>{};
+    auto id = [&](std::string_view line) {
+        return dict.try_emplace(line, dict.size()).first->second;
+    };
+    auto ids1 = to<ids_t>(r1 | std::views::transform(id));
+    auto ids2 = to<ids_t>(r2 | std::views::transform(id));
+    return {std::move(ids1), std::move(ids2), dict.size()};
+}
+
+/// Remove identifiers that are unique to one side, they never match.
+
+/// @param size - number of distinct identifiers
+/// @return original offsets of the remaining identifiers
+inline ids_t sift(ids_t& ids, const ids_t& other, std::size_t size)
 {
-    auto it = std::ranges::find(r, pattern);
-    return {{r.begin(), it}, {std::next(it), r.end()}};
+    auto found = std::vector<bool>(size);
+    for (auto id : other)
+        found[id] = true;
+    auto offsets = ids_t{};
+    auto it = ids.begin();
+    for (std::size_t i = 0; i < ids.size(); ++i)
+        if (found[ids[i]]) {
+            offsets.push_back(i);
+            *it++ = ids[i];
+        }
+    ids.erase(it, ids.end());
+    return offsets;
 }
 
-inline generator<pair_t> zip_split(range_t r1, range_t r2, range_t patterns)
+/// Shift insertions and deletions down as far as possible.
+
+/// Dropped unique lines affect how ties are broken, this makes output stable.
+inline std::vector<hunk_t> slide(std::vector<hunk_t> hunks,
+                                 const lines_t& lines1,
+                                 const lines_t& lines2)
+{
+    auto result = std::vector<hunk_t>{};
+    for (std::size_t i = 0; i < hunks.size(); ++i) {
+        auto& [r1, r2] = hunks[i];
+        bool next = i + 1 < hunks.size();
+        auto last1 = next ? hunks[i + 1].first.begin() : lines1.end();
+        auto last2 = next ? hunks[i + 1].second.begin() : lines2.end();
+        auto& r = r1.empty() ? r2 : r1;
+        auto last = r1.empty() ? last2 : last1;
+        while ((r1.empty() || r2.empty()) && r.end() != last &&
+               *r.begin() == *r.end()) {
+            r1 = {std::next(r1.begin()), std::next(r1.end())};
+            r2 = {std::next(r2.begin()), std::next(r2.end())};
+        }
+        if (next && r1.end() == last1 && r2.end() == last2)
+            hunks[i + 1] = {{r1.begin(), hunks[i + 1].first.end()},
+                            {r2.begin(), hunks[i + 1].second.end()}};
+        else
+            result.push_back(hunks[i]);
+    }
+    return result;
+}
+
+/// Line-level diff over integers instead of strings.
+
+/// Common prefix and suffix are stripped, unique lines are dropped,
+/// so the difference engine deals with a much smaller problem.
+inline std::vector<hunk_t> make_hunks(const lines_t& lines1,
+                                      const lines_t& lines2)
 {
-    for (auto pattern : patterns) {
-        auto [head1, tail1] = split(r1, pattern);
-        auto [head2, tail2] = split(r2, pattern);
-        co_yield {head1, head2};
-        r1 = tail1;
-        r2 = tail2;
+    auto [first1, first2] = std::ranges::mismatch(lines1, lines2);
+    auto tail = std::mismatch(lines1.rbegin(),
+                              std::reverse_iterator{first1},
+                              lines2.rbegin(),
+                              std::reverse_iterator{first2});
+    auto last1 = tail.first.base();
+    auto last2 = tail.second.base();
+    auto [ids1, ids2, size] = intern({first1, last1}, {first2, last2});
+    auto offsets1 = sift(ids1, ids2, size);
+    auto offsets2 = sift(ids2, ids1, size);
+    using ids_range_t = std::ranges::subrange<ids_t::const_iterator>;
+    auto diffs = std::vector<std::pair<ids_range_t, ids_range_t>>{};
+    longest_common_subsequence::diff(ids1, ids2, std::back_inserter(diffs));
+    auto result = std::vector<hunk_t>{};
+    auto prev1 = first1, prev2 = first2;
+    auto match = [&](auto it1, auto it2) {
+        if (it1 != prev1 || it2 != prev2)
+            result.push_back({{prev1, it1}, {prev2, it2}});
+        prev1 = std::next(it1);
+        prev2 = std::next(it2);
+    };
+    std::size_t i = 0, j = 0;
+    auto match_until = [&](std::size_t last_i) {
+        for (; i < last_i; ++i, ++j)
+            match(first1 + offsets1[i], first2 + offsets2[j]);
+    };
+    for (auto& [r1, r2] : diffs) {
+        match_until(r1.begin() - ids1.cbegin());
+        i += r1.size();
+        j += r2.size();
     }
-    co_yield {r1, r2};
+    match_until(ids1.size());
+    if (last1 != prev1 || last2 != prev2)
+        result.push_back({{prev1, last1}, {prev2, last2}});
+    return slide(std::move(result), lines1, lines2);
 }
 
 }  // namespace detail
@@ -50,12 +145,7 @@ inline void dump(std::string_view txt1, std::string_view txt2, std::ostream& os)
 {
     auto lines1 = detail::to_lines(txt1);
     auto lines2 = detail::to_lines(txt2);
-    auto patterns = detail::lines_t{};
-    longest_common_subsequence::copy(
-        lines1, lines2, std::back_inserter(patterns));
-    for (auto [r1, r2] : detail::zip_split(lines1, lines2, patterns)) {
-        if (r1.empty() && r2.empty())
-            continue;
+    for (auto [r1, r2] : detail::make_hunks(lines1, lines2)) {
         os << "@@ -" << (r1.begin() - lines1.begin() + 1) << "," << r1.size()
            << " +" << (r2.begin() - lines2.begin() + 1) << "," << r2.size()
            << " @@\n";
@@ -0,0 +1,197 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_EXPIRING_CACHE_HPP
+#define STEP20_EXPIRING_CACHE_HPP
+
+#include "detail/cache_observer.hpp"
+#include "detail/timer_wheel.hpp"
+#include "least_recently_used.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace step20 {
+
+/// Cache with per-item time to live.
+
+/// Expired items are erased proactively by a timer wheel on each call,
+/// so they free memory without scanning the cache.
+/// Each item owns one timer that is moved when the item is assigned
+/// and cancelled when it is evicted or erased.
+/// Timer resolution is one millisecond.
+/// Observer is notified of expired items as evicted ones.
+/// @param Cache - eviction policy with Weigher and Observer parameters,
+///                e.g. least_frequently_used::cache
+template <class Key,
+          class T,
+          template <class...> class Cache = least_recently_used::cache,
+          class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class Clock = std::chrono::steady_clock,
+          class Observer = null_observer>
+class expiring_cache {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using duration = typename Clock::duration;
+    using time_point = typename Clock::time_point;
+
+    /// @param ttl - default time to live
+    expiring_cache(std::size_t capacity, duration ttl)
+        : cache_(capacity), wheel_(ticks(Clock::now())), ttl_(ttl)
+    {
+    }
+
+    expiring_cache(expiring_cache&&) = default;
+    expiring_cache& operator=(expiring_cache&&) = default;
+    expiring_cache(const expiring_cache&) = delete;
+    expiring_cache& operator=(const expiring_cache&) = delete;
+    virtual ~expiring_cache() = default;
+
+    auto size() const { return cache_.size(); }
+    Observer& observer() { return cache_.observer(); }
+    const Observer& observer() const { return cache_.observer(); }
+
+    /// @return nullptr if key is not found or expired
+    template <class K>
+    const T* find(const K& key)
+    {
+        auto now = Clock::now();
+        expire(now);
+        if (auto ptr = cache_.peek(key); ptr && ptr->deadline <= now) {
+            wheel_.cancel(ptr->timer);  ///< expired before its timer tick
+            remove_expired(key);
+        }
+        auto ptr = cache_.find(key);
+        return ptr ? std::addressof(ptr->val) : nullptr;
+    }
+
+    template <class K, class M>
+    void insert_or_assign(K&& key, M&& val)
+    {
+        insert_or_assign(std::forward<K>(key), std::forward<M>(val), ttl_);
+    }
+
+    /// Timer of the replaced value is moved to the new deadline.
+    template <class K, class M>
+    void insert_or_assign(K&& key, M&& val, duration ttl)
+    {
+        auto now = Clock::now();
+        expire(now);
+        auto deadline = now + ttl;
+        auto tick =
+            ticks(std::chrono::ceil<std::chrono::milliseconds>(deadline));
+        if (auto ptr = cache_.peek(key)) {
+            auto timer = ptr->timer;
+            cache_.insert_or_assign(
+                std::forward<K>(key),
+                entry_type{std::forward<M>(val), deadline, timer});
+            wheel_.reschedule(timer, tick);
+        }
+        else {
+            auto timer = wheel_.schedule(tick, Key(key));
+            try {
+                cache_.insert_or_assign(
+                    std::forward<K>(key),
+                    entry_type{std::forward<M>(val), deadline, timer});
+            }
+            catch (...) {
+                auto& evicted = cache_.observer().evicted;
+                if (!cache_.peek(wheel_[timer]) &&
+                    std::ranges::find(evicted, timer) == evicted.end())
+                    wheel_.cancel(timer);
+                cancel_evicted();
+                throw;
+            }
+        }
+        cancel_evicted();
+    }
+
+    /// @return false if key is not found
+    template <class K>
+    bool erase(const K& key)
+    {
+        expire(Clock::now());
+        auto ptr = cache_.peek(key);
+        if (!ptr)
+            return false;
+        wheel_.cancel(ptr->timer);
+        return cache_.erase(key);
+    }
+
+    /// Number of pending timers, it never exceeds the number of items.
+    auto timers() const { return wheel_.size(); }
+
+private:
+    using timer_type = typename timer_wheel<Key>::handle;
+
+    struct entry_type {
+        T val;
+        time_point deadline;
+        timer_type timer;
+    };
+
+    /// Forwards notifications and collects timers of evicted items.
+    struct observer_type : Observer {
+        std::vector<timer_type> evicted;
+        bool expiring = false;
+
+        void on_evict(const auto& key, const entry_type& entry)
+        {
+            evicted.push_back(entry.timer);
+            Observer::on_evict(key, entry.val);
+        }
+
+        void on_erase(const auto& key, const entry_type& entry)
+        {
+            if (expiring)
+                Observer::on_evict(key, entry.val);
+            else
+                Observer::on_erase(key, entry.val);
+        }
+    };
+
+    Cache<Key, entry_type, Hash, KeyEqual, unit_weigher, observer_type> cache_;
+    timer_wheel<Key> wheel_;
+    duration ttl_;
+
+    template <class K>
+    void remove_expired(const K& key)
+    {
+        auto& observer = cache_.observer();
+        observer.expiring = true;
+        cache_.erase(key);
+        observer.expiring = false;
+    }
+
+    void cancel_evicted()
+    {
+        auto& evicted = cache_.observer().evicted;
+        for (auto timer : evicted)
+            wheel_.cancel(timer);
+        evicted.clear();
+    }
+
+    template <class Duration>
+    static uint64_t ticks(std::chrono::time_point<Clock, Duration> tp)
+    {
+        return std::chrono::floor<std::chrono::milliseconds>(tp)
+            .time_since_epoch()
+            .count();
+    }
+
+    void expire(time_point now)
+    {
+        wheel_.advance(ticks(now), [&](const Key& key) {
+            remove_expired(key);  ///< timer fires after the deadline
+        });
+    }
+};
+
+}  // namespace step20
+
+#endif  // STEP20_EXPIRING_CACHE_HPP
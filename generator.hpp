@@ -3,26 +3,238 @@
 #ifndef STEP20_GENERATOR_HPP
 #define STEP20_GENERATOR_HPP
 
+#include <array>
+#include <concepts>
 #include <coroutine>
+#include <cstddef>
+#include <exception>
 #include <iterator>
 #include <memory>
+#include <new>
 #include <optional>
+#include <ranges>
+#include <type_traits>
+#include <utility>
 
 namespace step20 {
 
+/// Stateless allocator that recycles blocks on the current thread.
+
+/// Blocks are grouped by size classes, large ones are not pooled.
+/// Block freed on another thread joins the pool of that thread.
+/// Blocks freed after the pool of the thread is destroyed
+/// (e.g. by other thread-local objects) go to operator delete.
+template <class T>
+struct pool_allocator {
+    using value_type = T;
+    pool_allocator() = default;
+
+    template <class U>
+    pool_allocator(const pool_allocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        auto bytes = n * sizeof(T);
+        auto i = bytes ? (bytes - 1) / granularity : 0;
+        auto pool = i < classes ? instance() : nullptr;
+        if (!pool)
+            return static_cast<T*>(::operator new(bytes));
+        auto& list = (*pool)[i];
+        if (!list.head)
+            return static_cast<T*>(::operator new((i + 1) * granularity));
+        --list.size;
+        return reinterpret_cast<T*>(std::exchange(list.head, list.head->next));
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept
+    {
+        auto bytes = n * sizeof(T);
+        auto i = bytes ? (bytes - 1) / granularity : 0;
+        auto pool = i < classes ? instance() : nullptr;
+        if (!pool || (*pool)[i].size == depth)
+            return ::operator delete(ptr);
+        auto& list = (*pool)[i];
+        ++list.size;
+        list.head = ::new (static_cast<void*>(ptr)) block_type{list.head};
+    }
+
+    friend bool operator==(const pool_allocator&, const pool_allocator&)
+    {
+        return true;
+    }
+
+private:
+    static constexpr std::size_t granularity = 64;
+    static constexpr std::size_t classes = 16;
+    static constexpr std::size_t depth = 16;  ///< free blocks per class
+
+    struct block_type {
+        block_type* next;
+    };
+
+    struct list_type {
+        block_type* head = nullptr;
+        std::size_t size = 0;
+    };
+
+    static inline thread_local bool destroyed_ = false;
+
+    struct pool_type : std::array<list_type, classes> {
+        ~pool_type()
+        {
+            destroyed_ = true;
+            for (auto& list : *this)
+                while (auto block = list.head) {
+                    list.head = block->next;
+                    ::operator delete(block);
+                }
+        }
+    };
+
+    /// @return nullptr during destruction of thread-local objects
+    ///         after the pool is gone, blocks bypass it then
+    static pool_type* instance()
+    {
+        if (destroyed_)
+            return nullptr;
+        thread_local auto result = pool_type{};
+        return &result;
+    }
+};
+
+/// Coroutine frame allocation with the Allocator.
+
+/// Allocator is passed to the coroutine after std::allocator_arg,
+/// or it is default constructed. Stateful allocator is stored
+/// at the end of the frame.
+template <class Allocator>
+class frame_allocation {
+    struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) block_type {
+        std::byte data[__STDCPP_DEFAULT_NEW_ALIGNMENT__];
+    };
+
+    using alloc_type = typename std::allocator_traits<
+        Allocator>::template rebind_alloc<block_type>;
+    using traits = std::allocator_traits<alloc_type>;
+    static constexpr bool stateless_v =
+        traits::is_always_equal::value &&
+        std::default_initializable<alloc_type>;
+
+    static std::size_t offset(std::size_t size)
+    {
+        constexpr auto align = alignof(alloc_type);
+        return (size + align - 1) / align * align;
+    }
+
+    static std::size_t blocks(std::size_t size)
+    {
+        if constexpr (!stateless_v)
+            size = offset(size) + sizeof(alloc_type);
+        return (size + sizeof(block_type) - 1) / sizeof(block_type);
+    }
+
+    static void* allocate(alloc_type alloc, std::size_t size)
+    {
+        auto ptr = traits::allocate(alloc, blocks(size));
+        if constexpr (!stateless_v)
+            ::new (reinterpret_cast<std::byte*>(ptr) + offset(size))
+                alloc_type(std::move(alloc));
+        return ptr;
+    }
+
+public:
+    static void* operator new(std::size_t size)
+        requires std::default_initializable<alloc_type>
+    {
+        return allocate(alloc_type{}, size);
+    }
+
+    template <class Alloc, class... Args>
+    static void* operator new(std::size_t size,
+                              std::allocator_arg_t,
+                              const Alloc& alloc,
+                              const Args&...)
+    {
+        return allocate(alloc_type(alloc), size);
+    }
+
+    /// Member coroutine
+    template <class This, class Alloc, class... Args>
+    static void* operator new(std::size_t size,
+                              const This&,
+                              std::allocator_arg_t,
+                              const Alloc& alloc,
+                              const Args&...)
+    {
+        return allocate(alloc_type(alloc), size);
+    }
+
+    static void operator delete(void* ptr, std::size_t size) noexcept
+    {
+        auto alloc = [&] {
+            if constexpr (stateless_v)
+                return alloc_type{};
+            else {
+                auto& stored = *std::launder(reinterpret_cast<alloc_type*>(
+                    static_cast<std::byte*>(ptr) + offset(size)));
+                auto result = std::move(stored);
+                stored.~alloc_type();
+                return result;
+            }
+        }();
+        traits::deallocate(alloc, static_cast<block_type*>(ptr), blocks(size));
+    }
+};
+
 inline auto co_destroy = [](void* address) {
     std::coroutine_handle<>::from_address(address).destroy();
 };
 
+/// Yield elements of the range one by one.
+
+/// Nested generator of the same type is resumed directly,
+/// other ranges are iterated.
+template <std::ranges::range R>
+struct elements_of {
+    [[no_unique_address]] R range;
+};
+
+template <class R>
+elements_of(R&&) -> elements_of<R&&>;
+
 /// @see https://en.cppreference.com/w/cpp/header/generator
-template <std::movable T>
+/// Frames come from the thread-local pool by default,
+/// so that generators created in a loop do not call malloc.
+/// Body starts on begin().
+template <std::movable T, class Allocator = pool_allocator<std::byte>>
 struct generator : private std::unique_ptr<void, decltype(co_destroy)> {
-    struct promise_type : std::optional<T> {
-        std::suspend_never initial_suspend() { return {}; }
+    struct promise_type;
+    using handle = std::coroutine_handle<promise_type>;
+
+private:
+    struct final_awaiter;
+    struct nested_awaiter;
+
+public:
+    struct promise_type : std::optional<T>, frame_allocation<Allocator> {
+        promise_type* root = this;
+        promise_type* leaf = this;  ///< innermost active promise of the root
+        promise_type* parent = nullptr;
+        std::exception_ptr error;  ///< of the nested generator
+
+        std::suspend_always initial_suspend() { return {}; }
         void await_transform() = delete;
         void return_void() {}
-        void unhandled_exception() { throw; }
-        std::suspend_always final_suspend() noexcept { return {}; }
+        final_awaiter final_suspend() noexcept { return {}; }
+
+        void unhandled_exception()
+        {
+            if (!parent)
+                throw;
+            error = std::current_exception();
+        }
 
         std::suspend_always yield_value(T value)
         {
@@ -30,6 +242,19 @@ struct generator : private std::unique_ptr<void, decltype(co_destroy)> {
             return {};
         }
 
+        template <class R>
+        nested_awaiter yield_value(elements_of<R> elements)
+        {
+            if constexpr (std::same_as<std::remove_cvref_t<R>, generator>)
+                return nested_awaiter{
+                    {}, handle::from_address(elements.range.get())};
+            else {
+                auto gen = flatten(std::forward<R>(elements.range));
+                auto nested = handle::from_address(gen.get());
+                return nested_awaiter{std::move(gen), nested};
+            }
+        }
+
         generator get_return_object()
         {
             auto result = generator{};
@@ -38,27 +263,78 @@ struct generator : private std::unique_ptr<void, decltype(co_destroy)> {
         }
     };
 
-    using handle = std::coroutine_handle<promise_type>;
-
     struct iterator : private handle {
         using iterator_category = std::input_iterator_tag;
         using difference_type = std::ptrdiff_t;
         using value_type = T;
         using reference = const T&;
         explicit iterator(handle coro) : handle{coro} {}
-        reference operator*() const { return *this->promise(); }
+        reference operator*() const { return **this->promise().leaf; }
         bool operator==(std::default_sentinel_t) const { return this->done(); }
-        void operator++(int) { this->resume(); }
+        void operator++(int) { ++*this; }
 
         iterator& operator++()
         {
-            this->resume();
+            handle::from_promise(*this->promise().leaf).resume();
             return *this;
         }
     };
 
-    auto begin() const { return iterator{handle::from_address(get())}; }
+    /// Single pass: the body is resumed up to the first element.
+    auto begin() const
+    {
+        auto coro = handle::from_address(get());
+        coro.resume();
+        return iterator{coro};
+    }
+
     auto end() const { return std::default_sentinel; }
+
+private:
+    /// Symmetric transfer from the finished nested generator to its parent.
+    struct final_awaiter {
+        bool await_ready() noexcept { return false; }
+        void await_resume() noexcept {}
+
+        std::coroutine_handle<> await_suspend(handle coro) noexcept
+        {
+            auto& promise = coro.promise();
+            if (!promise.parent)
+                return std::noop_coroutine();
+            promise.root->leaf = promise.parent;
+            return handle::from_promise(*promise.parent);
+        }
+    };
+
+    /// Symmetric transfer from the parent to the nested generator.
+    struct nested_awaiter {
+        generator owner;  ///< empty if the generator is owned by the caller
+        handle nested;
+
+        bool await_ready() noexcept { return !nested || nested.done(); }
+
+        std::coroutine_handle<> await_suspend(handle coro) noexcept
+        {
+            auto& promise = nested.promise();
+            promise.root = coro.promise().root;
+            promise.parent = std::addressof(coro.promise());
+            promise.root->leaf = std::addressof(promise);
+            return nested;
+        }
+
+        void await_resume()
+        {
+            if (nested && nested.promise().error)
+                std::rethrow_exception(nested.promise().error);
+        }
+    };
+
+    template <class R>
+    static generator flatten(R&& range)
+    {
+        for (auto&& item : range)
+            co_yield static_cast<T>(item);
+    }
 };
 
 }  // namespace step20
@@ -3,17 +3,28 @@
 #ifndef STEP20_LEAST_FREQUENTLY_USED_HPP
 #define STEP20_LEAST_FREQUENTLY_USED_HPP
 
+#include "detail/count_min_sketch.hpp"
+#include "least_recently_used.hpp"
 #include <algorithm>
 #include <list>
+#include <optional>
+#include <ranges>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace step20::least_frequently_used {
 
 /// An O(1) algorithm for implementing the LFU cache eviction scheme
+
+/// Weigher(key, value) must return the same weight for the same item.
+/// Observer is notified of hits and misses of lookups, evictions and erasures.
 template <class Key,
           class T,
           class Hash = std::hash<Key>,
-          class KeyEqual = std::equal_to<Key>>
+          class KeyEqual = std::equal_to<Key>,
+          class Weigher = unit_weigher,
+          class Observer = null_observer>
 class cache {
     struct item_type;
     using item_list = std::list<item_type>;
@@ -26,6 +37,14 @@ class cache {
         freq_iterator parent;
         Key key;
         T val;
+
+        template <class K, class... Args>
+        item_type(freq_iterator parent, K&& key, Args&&... args)
+            : parent(parent)
+            , key(std::forward<K>(key))
+            , val(std::forward<Args>(args)...)
+        {
+        }
     };
 
     struct freq_type {
@@ -34,35 +53,36 @@ class cache {
     };
 
     freq_list list_;
-    std::unordered_map<Key, item_iterator, Hash, KeyEqual> map_;
+    std::unordered_map<const Key*,
+                       item_iterator,
+                       indirect_hash<Key, Hash>,
+                       indirect_equal<Key, KeyEqual>>
+        map_;  ///< keys are stored once, in the items
     std::size_t capacity_;
+    bool aging_;
+    std::size_t max_weight_;
+    std::size_t weight_ = 0;
+    std::size_t age_ = 0;  ///< frequency of the last evicted item
+    [[no_unique_address]] Observer observer_;
 
     bool equal(freq_iterator it, std::size_t n) const
     {
         return it != list_.end() && it->n == n;
     }
 
-public:
-    explicit cache(std::size_t capacity) : capacity_(capacity) {}
-    cache(cache&&) = default;
-    cache& operator=(cache&&) = default;
-    cache(const cache&) = delete;
-    cache& operator=(const cache&) = delete;
-    virtual ~cache() = default;
+    static std::size_t weigh(const item_type& item)
+    {
+        return Weigher{}(item.key, std::as_const(item.val));
+    }
 
-    /// @return nullptr if key is not found
-    const T* find(const Key& key)
+    void touch(item_iterator item)
     {
-        auto it = map_.find(key);
-        if (it == map_.end())
-            return nullptr;
-        auto item = it->second;
         auto freq = item->parent;
         auto next = std::next(freq);
         if (!equal(next, freq->n + 1)) {
             if (freq->items.size() == 1) {
                 ++freq->n;
-                return std::addressof(item->val);
+                return;
             }
             next = list_.emplace(next, freq->n + 1);
         }
@@ -77,40 +97,375 @@ public:
         item->parent = next;
         if (freq->items.empty())
             list_.erase(freq);
-        return std::addressof(item->val);
     }
 
-    /// Basic exception guarantee.
-    /// Evicted item is not restored if an exception occurs.
-    void insert_or_assign(const Key& key, const T& val)
+    void remove(item_iterator item)
     {
-        if (auto ptr = find(key)) {
-            *const_cast<T*>(ptr) = val;
+        auto freq = item->parent;
+        weight_ -= weigh(*item);
+        map_.erase(std::addressof(item->key));
+        freq->items.erase(item);
+        if (freq->items.empty())
+            list_.erase(freq);
+    }
+
+    /// Evict the least frequently used item other than the given one.
+    void evict(const item_type* except)
+    {
+        auto freq = list_.begin();
+        auto item = freq->items.begin();
+        if (std::addressof(*item) == except && ++item == freq->items.end())
+            item = (++freq)->items.begin();
+        if (aging_)
+            age_ = freq->n;
+        observer_.on_evict(std::as_const(item->key), std::as_const(item->val));
+        remove(item);
+    }
+
+    /// Move the item to the bucket of frequency n.
+    void assign(item_iterator item, std::size_t n)
+    {
+        auto freq = item->parent;
+        if (freq->n == n)
             return;
+        auto pos = list_.end();
+        while (pos != list_.begin() && std::prev(pos)->n >= n)
+            --pos;  ///< saved buckets come in ascending order
+        if (!equal(pos, n))
+            pos = list_.emplace(pos, n);
+        pos->items.splice(pos->items.end(), freq->items, item);
+        item->parent = pos;
+        if (freq->items.empty())
+            list_.erase(freq);
+    }
+
+    /// @return std::nullopt if the item is too heavy
+    template <class K, class... Args>
+    auto emplace(std::size_t max_weight, K&& key, Args&&... args)
+        -> std::optional<std::pair<item_iterator, bool>>
+    {
+        if (auto it = map_.find(key); it != map_.end()) {
+            touch(it->second);
+            return std::pair{it->second, false};
         }
-        if (map_.size() >= std::max<std::size_t>(1, capacity_)) {
-            auto freq = list_.begin();
-            auto item = freq->items.begin();
-            map_.erase(item->key);
-            freq->items.erase(item);
-            if (freq->items.empty())
-                list_.erase(freq);
-        }
+        auto items = item_list{};  ///< weigh the item before evictions
+        auto item = items.emplace(items.end(),
+                                  freq_iterator{},
+                                  std::forward<K>(key),
+                                  std::forward<Args>(args)...);
+        auto weight = weigh(*item);
+        if (weight > max_weight)
+            return std::nullopt;
+        while (!map_.empty() && weight_ + weight > capacity_)
+            evict(nullptr);
+        auto n = age_ + 1;
         auto freq = list_.begin();
-        auto exists = equal(freq, 1);
-        freq = exists ? freq : list_.emplace(freq, 1);
-        auto item = freq->items.end();
+        if (freq != list_.end() && freq->n < n)
+            ++freq;  ///< only the bucket of age precedes
+        auto exists = equal(freq, n);
+        freq = exists ? freq : list_.emplace(freq, n);
         try {
-            item = freq->items.emplace(item, freq, key, val);
-            map_.emplace(key, item);
+            map_.emplace(std::addressof(item->key), item);
         }
         catch (...) {
             if (!exists)
                 list_.erase(freq);
-            else if (item != freq->items.end())
-                freq->items.erase(item);
             throw;
         }
+        freq->items.splice(freq->items.end(), items, item);
+        item->parent = freq;
+        weight_ += weight;
+        return std::pair{item, true};
+    }
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+
+    /// @param capacity - total weight budget
+    /// @param aging - dynamic aging (LFU-DA): new item starts with
+    /// the frequency of the last evicted one, so stale hot items get old
+    /// @param max_weight - heavier items are rejected
+    explicit cache(std::size_t capacity,
+                   bool aging = false,
+                   std::size_t max_weight = SIZE_MAX)
+        : capacity_(capacity), aging_(aging), max_weight_(max_weight)
+    {
+    }
+
+    cache(cache&&) = default;
+    cache& operator=(cache&&) = default;
+    cache(const cache&) = delete;
+    cache& operator=(const cache&) = delete;
+    virtual ~cache() = default;
+
+    auto size() const { return map_.size(); }
+    auto weight() const { return weight_; }
+    Observer& observer() { return observer_; }
+    const Observer& observer() const { return observer_; }
+
+    /// @return number of items for each frequency in ascending order
+    std::vector<std::pair<std::size_t, std::size_t>> frequency_histogram() const
+    {
+        auto result = std::vector<std::pair<std::size_t, std::size_t>>{};
+        for (auto& freq : list_)
+            result.emplace_back(freq.n, freq.items.size());
+        return result;
+    }
+
+    /// @return key to be evicted next or nullptr if cache is empty
+    const Key* victim() const
+    {
+        return list_.empty() ? nullptr
+                             : std::addressof(list_.front().items.front().key);
+    }
+
+    /// Heterogeneous lookup is supported if Hash and KeyEqual accept K.
+    /// @return nullptr if key is not found
+    template <class K>
+    const T* find(const K& key)
+    {
+        auto it = map_.find(key);
+        if (it == map_.end()) {
+            observer_.on_miss(key);
+            return nullptr;
+        }
+        observer_.on_hit(key);
+        touch(it->second);
+        return std::addressof(it->second->val);
+    }
+
+    /// @param result - output iterator of const T*, nullptr if not found
+    template <std::ranges::input_range R, std::weakly_incrementable O>
+    O find_many(const R& keys, O result)
+    {
+        for (auto& key : keys)
+            *result++ = find(key);
+        return result;
+    }
+
+    /// @param items - range of key-value pairs,
+    ///                elements of the owning rvalue range are moved from
+    template <std::ranges::input_range R>
+    void insert_many(R&& items)
+    {
+        for (auto&& [key, val] : items)
+            if constexpr (movable_elements_v<R>)
+                insert_or_assign(std::move(key), std::move(val));
+            else
+                insert_or_assign(key, val);
+    }
+
+    /// Item is not touched.
+    /// @return nullptr if key is not found
+    template <class K>
+    const T* peek(const K& key)
+    {
+        auto it = map_.find(key);
+        return it == map_.end() ? nullptr : std::addressof(it->second->val);
+    }
+
+    /// Write items with their frequencies in the order of eviction.
+    template <class KeyCodec = codec<Key>, class ValueCodec = codec<T>>
+    void save(std::ostream& os,
+              const KeyCodec& key_codec = {},
+              const ValueCodec& val_codec = {}) const
+    {
+        codec<uint64_t>::encode(os, age_);
+        codec<uint64_t>::encode(os, map_.size());
+        for (auto& freq : list_)
+            for (auto& item : freq.items) {
+                codec<uint64_t>::encode(os, freq.n);
+                key_codec.encode(os, item.key);
+                val_codec.encode(os, item.val);
+            }
+    }
+
+    /// Items are inserted in the saved order with their frequencies,
+    /// so the least frequently used ones are evicted if capacity is less.
+    /// Saved frequencies are rebased from the saved age onto the current
+    /// one, so no item falls behind the age of a populated cache.
+    /// Existing items keep their values and are touched.
+    template <class KeyCodec = codec<Key>, class ValueCodec = codec<T>>
+    void load(std::istream& is,
+              const KeyCodec& key_codec = {},
+              const ValueCodec& val_codec = {})
+    {
+        std::size_t age = codec<uint64_t>::decode(is);
+        if (aging_ && map_.empty())
+            age_ = age;
+        auto base = age_;
+        for (auto n = codec<uint64_t>::decode(is); n; --n) {
+            std::size_t freq = codec<uint64_t>::decode(is);
+            auto key = key_codec.decode(is);
+            auto result =
+                emplace(max_weight_, std::move(key), val_codec.decode(is));
+            if (result && result->second)  ///< evictions may raise the age
+                assign(result->first,
+                       std::max(freq - std::min(freq, age) + base, age_));
+        }
+    }
+
+    /// @return false if key is not found
+    template <class K>
+    bool erase(const K& key)
+    {
+        auto it = map_.find(key);
+        if (it == map_.end())
+            return false;
+        auto item = it->second;
+        observer_.on_erase(std::as_const(item->key), std::as_const(item->val));
+        remove(item);
+        return true;
+    }
+
+    /// Basic exception guarantee.
+    /// Evicted item is not restored if an exception occurs.
+    /// Existing item is erased if the new value is too heavy.
+    template <class K, class M>
+    void insert_or_assign(K&& key, M&& val)
+    {
+        auto result =
+            emplace(max_weight_, std::forward<K>(key), std::forward<M>(val));
+        if (!result || result->second)
+            return;
+        auto item = result->first;
+        weight_ -= weigh(*item);
+        try {
+            item->val = std::forward<M>(val);
+        }
+        catch (...) {
+            weight_ += weigh(*item);
+            throw;
+        }
+        auto weight = weigh(*item);
+        weight_ += weight;
+        if (weight > max_weight_)
+            return remove(item);
+        while (weight_ > capacity_ && map_.size() > 1)
+            evict(std::addressof(*item));
+    }
+
+    /// Arguments are not moved from if the key exists.
+    /// @return false if key exists or the item is too heavy
+    template <class K, class... Args>
+    bool try_emplace(K&& key, Args&&... args)
+    {
+        auto result = emplace(max_weight_,
+                              std::forward<K>(key),
+                              std::forward<Args>(args)...);
+        return result && result->second;
+    }
+
+    /// Factory is called to construct the value in place if key is not found.
+    /// The value is never rejected since a reference to it is returned.
+    template <class K, class F>
+    const T& get_or_insert_with(K&& key, F&& factory)
+    {
+        if constexpr (!deferrable_v<T>)
+            if (auto it = map_.find(key); it != map_.end()) {
+                observer_.on_hit(key);
+                touch(it->second);
+                return it->second->val;
+            }
+        auto [item, success] = *emplace(
+            SIZE_MAX, std::forward<K>(key), in_place_arg<T>(factory));
+        if (success)
+            observer_.on_miss(std::as_const(item->key));
+        else
+            observer_.on_hit(std::as_const(item->key));
+        return item->val;
+    }
+};
+
+/// W-TinyLFU: LRU window in front of LFU cache with admission filter.
+
+/// Item evicted from the window replaces the victim of the main cache
+/// only if its estimated frequency is higher, so scans do not flush it.
+/// Frequency of all keys, including evicted ones, is kept in a sketch.
+template <class Key,
+          class T,
+          class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>>
+class tiny_cache {
+    std::size_t window_capacity_;
+    std::size_t main_capacity_;
+    least_recently_used::detail::linked_hash_map<Key, T, Hash, KeyEqual>
+        window_;
+    cache<Key, T, Hash, KeyEqual> main_;
+    count_min_sketch sketch_;
+
+    bool admit(const Key& candidate) const
+    {
+        if (main_.size() < main_capacity_)
+            return true;
+        auto victim = main_.victim();
+        return victim && sketch_.estimate(Hash{}(candidate)) >
+                             sketch_.estimate(Hash{}(*victim));
+    }
+
+    /// Sketch is not touched.
+    const T* lookup(const Key& key)
+    {
+        if (auto it = window_.find(key); it != window_.end()) {
+            window_.transfer(it, window_.end());
+            return std::addressof(it->second);
+        }
+        return main_.find(key);
+    }
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+
+    /// One percent of capacity is given to the window.
+    explicit tiny_cache(std::size_t capacity)
+        : window_capacity_(
+              std::min(capacity, std::max<std::size_t>(1, capacity / 100)))
+        , main_capacity_(capacity - window_capacity_)
+        , main_(main_capacity_)
+        , sketch_(capacity)
+    {
+    }
+
+    tiny_cache(tiny_cache&&) = default;
+    tiny_cache& operator=(tiny_cache&&) = default;
+    tiny_cache(const tiny_cache&) = delete;
+    tiny_cache& operator=(const tiny_cache&) = delete;
+    virtual ~tiny_cache() = default;
+
+    auto size() const { return window_.size() + main_.size(); }
+
+    /// @return nullptr if key is not found
+    const T* find(const Key& key)
+    {
+        sketch_.add(Hash{}(key));
+        return lookup(key);
+    }
+
+    /// Writes are not counted as accesses, so the usual
+    /// find-then-insert on a miss counts the key once.
+    /// Basic exception guarantee.
+    /// Evicted item is not restored if an exception occurs.
+    void insert_or_assign(const Key& key, const T& val)
+    {
+        if (auto ptr = lookup(key)) {
+            *const_cast<T*>(ptr) = val;
+            return;
+        }
+        if (!window_capacity_)
+            return;
+        window_.try_emplace(window_.end(), key, val);
+        if (window_.size() <= window_capacity_)
+            return;
+        auto candidate = window_.begin();
+        if (admit(candidate->first))
+            main_.try_emplace(candidate->first, std::move(candidate->second));
+        window_.erase(candidate);
     }
 };
 
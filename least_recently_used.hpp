@@ -3,8 +3,25 @@
 #ifndef STEP20_LEAST_RECENTLY_USED_HPP
 #define STEP20_LEAST_RECENTLY_USED_HPP
 
+#include "detail/cache_observer.hpp"
+#include "detail/codec.hpp"
+#include "detail/utility.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <limits>
 #include <list>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <tuple>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace step20::least_recently_used {
 namespace detail {
@@ -29,7 +46,15 @@ public:
     iterator end() { return list_.end(); }
     void transfer(iterator from, iterator to) { list_.splice(to, list_, from); }
 
-    iterator find(const Key& key)
+    template <class F>
+    void for_each(F fn) const
+    {
+        for (auto& item : list_)
+            fn(item);
+    }
+
+    template <class K>
+    iterator find(const K& key)
     {
         auto it = map_.find(key);
         return it == map_.end() ? list_.end() : it->second;
@@ -37,18 +62,22 @@ public:
 
     iterator erase(iterator it)
     {
-        map_.erase(it->first);
+        map_.erase(std::addressof(it->first));
         return list_.erase(it);
     }
 
-    template <class M>
-    std::pair<iterator, bool> emplace(iterator it, const Key& key, M&& val)
+    /// Arguments are not moved from if the key exists.
+    template <class K, class... Args>
+    std::pair<iterator, bool> try_emplace(iterator it, K&& key, Args&&... args)
     {
         if (auto pos = find(key); pos != end())
             return {pos, false};
-        it = list_.emplace(it, key, std::forward<M>(val));
+        it = list_.emplace(it,
+                           std::piecewise_construct,
+                           std::forward_as_tuple(std::forward<K>(key)),
+                           std::forward_as_tuple(std::forward<Args>(args)...));
         try {
-            map_.emplace(key, it);
+            map_.emplace(std::addressof(it->first), it);
             return {it, true};
         }
         catch (...) {
@@ -59,50 +88,644 @@ public:
 
 private:
     list_type list_;
-    std::unordered_map<Key, iterator, Hash, KeyEqual> map_;
+    std::unordered_map<const Key*,
+                       iterator,
+                       indirect_hash<Key, Hash>,
+                       indirect_equal<Key, KeyEqual>>
+        map_;  ///< keys are stored once, in the list
+};
+
+/// Open addressing table with intrusive links in one contiguous slab.
+
+/// Nodes are linked by indices, so iterators survive reallocation,
+/// but references are stable only within the reserved size.
+/// Linear probing with backward shift deletion keeps no tombstones.
+template <class Key,
+          class T,
+          class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>>
+class flat_linked_hash_map {
+    using index_t = uint32_t;  ///< zero is reserved for the end
+
+public:
+    using value_type = std::pair<const Key, T>;
+
+    class iterator {
+        friend flat_linked_hash_map;
+        flat_linked_hash_map* map_ = nullptr;
+        index_t pos_ = 0;
+
+        iterator(flat_linked_hash_map* map, index_t pos)
+            : map_(map), pos_(pos)
+        {
+        }
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = flat_linked_hash_map::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = value_type*;
+        using reference = value_type&;
+
+        iterator() = default;
+        reference operator*() const { return *map_->at(pos_).val; }
+        pointer operator->() const { return std::addressof(**this); }
+        friend bool operator==(const iterator&, const iterator&) = default;
+
+        iterator& operator++()
+        {
+            pos_ = map_->at(pos_).next;
+            return *this;
+        }
+
+        iterator& operator--()
+        {
+            pos_ = pos_ ? map_->at(pos_).prev : map_->tail_;
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            auto result = *this;
+            ++*this;
+            return result;
+        }
+
+        iterator operator--(int)
+        {
+            auto result = *this;
+            --*this;
+            return result;
+        }
+    };
+
+    flat_linked_hash_map() = default;
+    flat_linked_hash_map(flat_linked_hash_map&& other) noexcept { swap(other); }
+    flat_linked_hash_map(const flat_linked_hash_map&) = delete;
+    flat_linked_hash_map& operator=(const flat_linked_hash_map&) = delete;
+    virtual ~flat_linked_hash_map() = default;
+
+    flat_linked_hash_map& operator=(flat_linked_hash_map&& other) noexcept
+    {
+        auto tmp = std::move(other);
+        swap(tmp);
+        return *this;
+    }
+
+    auto size() const { return size_; }
+    iterator begin() { return {this, head_}; }
+    iterator end() { return {this, 0}; }
+
+    template <class F>
+    void for_each(F fn) const
+    {
+        for (auto pos = head_; pos; pos = nodes_[pos - 1].next)
+            fn(*nodes_[pos - 1].val);
+    }
+
+    /// Allocate storage once, so no allocations occur up to this size.
+    void reserve(std::size_t n)
+    {
+        if (n >= std::numeric_limits<index_t>::max() / 2)
+            throw std::length_error("flat_linked_hash_map");
+        nodes_.reserve(n);
+        if (n * 2 > buckets_.size())
+            rehash(std::bit_ceil(std::max<std::size_t>(n * 2, 16)));
+    }
+
+    void transfer(iterator from, iterator to)
+    {
+        if (from == to)
+            return;
+        unlink(from.pos_);
+        link(from.pos_, to.pos_);
+    }
+
+    template <class K>
+    iterator find(const K& key)
+    {
+        return find(key, hash(key));
+    }
+
+    /// Lookup by the hash that is computed in advance.
+    template <class K>
+    iterator find(const K& key, index_t h)
+    {
+        if (buckets_.empty())
+            return end();
+        return {this, buckets_[probe(key, h)].pos};
+    }
+
+    template <class K>
+    index_t hash(const K& key) const
+    {
+        return ((uint64_t)Hash{}(key) * 0x9e3779b97f4a7c15ull) >> 32;
+    }
+
+    /// Hint to load the bucket while other work is done.
+    void prefetch(index_t h) const
+    {
+        if (!buckets_.empty())
+            step20::prefetch(buckets_.data() + (h & (buckets_.size() - 1)));
+    }
+
+    iterator erase(iterator it)
+    {
+        auto pos = it.pos_;
+        auto& node = at(pos);
+        auto mask = buckets_.size() - 1;
+        auto i = probe(node.val->first, hash(node.val->first));
+        for (auto j = (i + 1) & mask; buckets_[j].pos; j = (j + 1) & mask) {
+            auto ideal = buckets_[j].hash & mask;
+            if (((j - ideal) & mask) >= ((j - i) & mask)) {
+                buckets_[i] = buckets_[j];
+                i = j;
+            }
+        }
+        buckets_[i] = {};
+        ++it;
+        unlink(pos);
+        release(pos);
+        --size_;
+        return it;
+    }
+
+    /// The key is hashed and probed once.
+    /// Arguments are not moved from if the key exists.
+    template <class K, class... Args>
+    std::pair<iterator, bool> try_emplace(iterator it, K&& key, Args&&... args)
+    {
+        if ((size_ + 1) * 2 > buckets_.size())
+            reserve(std::max<std::size_t>(size_ + 1, buckets_.size()));
+        auto h = hash(key);
+        auto i = probe(key, h);
+        if (buckets_[i].pos)
+            return {{this, buckets_[i].pos}, false};
+        auto pos = acquire();
+        try {
+            at(pos).val.emplace(
+                std::piecewise_construct,
+                std::forward_as_tuple(std::forward<K>(key)),
+                std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+        catch (...) {
+            release(pos);
+            throw;
+        }
+        buckets_[i] = {pos, h};
+        link(pos, it.pos_);
+        ++size_;
+        return {{this, pos}, true};
+    }
+
+private:
+    struct node_type {
+        std::optional<value_type> val;
+        index_t prev;
+        index_t next;
+    };
+
+    struct bucket_type {
+        index_t pos;  ///< zero if empty
+        index_t hash;
+    };
+
+    std::vector<node_type> nodes_;  ///< [pos - 1]
+    std::vector<bucket_type> buckets_;
+    index_t head_ = 0;
+    index_t tail_ = 0;
+    index_t free_ = 0;  ///< singly linked through node_type::next
+    std::size_t size_ = 0;
+
+    node_type& at(index_t pos) { return nodes_[pos - 1]; }
+
+    /// @return bucket of the key or the empty one to insert it
+    template <class K>
+    std::size_t probe(const K& key, index_t h)
+    {
+        auto mask = buckets_.size() - 1;
+        auto i = h & mask;
+        for (; buckets_[i].pos; i = (i + 1) & mask)
+            if (buckets_[i].hash == h &&
+                KeyEqual{}(at(buckets_[i].pos).val->first, key))
+                break;
+        return i;
+    }
+
+    void rehash(std::size_t n)
+    {
+        auto buckets = std::vector<bucket_type>(n);
+        for (auto& bucket : buckets_)
+            if (bucket.pos) {
+                auto i = bucket.hash & (n - 1);
+                while (buckets[i].pos)
+                    i = (i + 1) & (n - 1);
+                buckets[i] = bucket;
+            }
+        buckets_.swap(buckets);
+    }
+
+    index_t acquire()
+    {
+        if (free_)
+            return std::exchange(free_, at(free_).next);
+        nodes_.emplace_back();
+        return (index_t)nodes_.size();
+    }
+
+    void release(index_t pos)
+    {
+        at(pos).val.reset();
+        at(pos).next = std::exchange(free_, pos);
+    }
+
+    /// Insert before the next node or at the end if it is zero.
+    void link(index_t pos, index_t next)
+    {
+        auto prev = next ? at(next).prev : tail_;
+        at(pos).prev = prev;
+        at(pos).next = next;
+        (prev ? at(prev).next : head_) = pos;
+        (next ? at(next).prev : tail_) = pos;
+    }
+
+    void unlink(index_t pos)
+    {
+        auto prev = at(pos).prev;
+        auto next = at(pos).next;
+        (prev ? at(prev).next : head_) = next;
+        (next ? at(next).prev : tail_) = prev;
+    }
+
+    void swap(flat_linked_hash_map& other) noexcept
+    {
+        nodes_.swap(other.nodes_);
+        buckets_.swap(other.buckets_);
+        std::swap(head_, other.head_);
+        std::swap(tail_, other.tail_);
+        std::swap(free_, other.free_);
+        std::swap(size_, other.size_);
+    }
 };
 
 }  // namespace detail
 
 /// An O(1) algorithm for implementing the LRU cache eviction scheme
+
+/// Weigher(key, value) must return the same weight for the same item.
+/// Observer is notified of hits and misses of lookups, evictions and erasures.
 template <class Key,
           class T,
           class Hash = std::hash<Key>,
-          class KeyEqual = std::equal_to<Key>>
+          class KeyEqual = std::equal_to<Key>,
+          class Weigher = unit_weigher,
+          class Observer = null_observer,
+          class Map = detail::linked_hash_map<Key, T, Hash, KeyEqual>>
 class cache {
-    detail::linked_hash_map<Key, T, Hash, KeyEqual> map_;
+    using iterator = typename Map::iterator;
+    Map map_;
     std::size_t capacity_;
+    std::size_t max_weight_;
+    std::size_t weight_ = 0;
+    [[no_unique_address]] Observer observer_;
 
 public:
-    explicit cache(std::size_t capacity) : capacity_(capacity) {}
+    using key_type = Key;
+    using mapped_type = T;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+
+    /// @param capacity - total weight budget
+    /// @param max_weight - heavier items are rejected
+    explicit cache(std::size_t capacity, std::size_t max_weight = SIZE_MAX)
+        : capacity_(capacity), max_weight_(max_weight)
+    {
+        if constexpr (std::same_as<Weigher, unit_weigher> &&
+                      requires { map_.reserve(capacity); })
+            map_.reserve(capacity + 1);
+    }
+
     cache(cache&&) = default;
     cache& operator=(cache&&) = default;
     cache(const cache&) = delete;
     cache& operator=(const cache&) = delete;
     virtual ~cache() = default;
 
+    auto size() const { return map_.size(); }
+    auto weight() const { return weight_; }
+    Observer& observer() { return observer_; }
+    const Observer& observer() const { return observer_; }
+
+    /// Heterogeneous lookup is supported if Hash and KeyEqual accept K.
+    /// @return nullptr if key is not found
+    template <class K>
+    const T* find(const K& key)
+    {
+        return visit(key, map_.find(key));
+    }
+
+    /// Keys are hashed and their buckets are prefetched in advance
+    /// if the map supports it, so that cache misses overlap.
+    /// @param result - output iterator of const T*, nullptr if not found
+    template <std::ranges::forward_range R, std::weakly_incrementable O>
+    O find_many(const R& keys, O result)
+    {
+        using key_t = std::ranges::range_value_t<R>;
+        if constexpr (requires(const key_t& key) {
+                          map_.prefetch(map_.hash(key));
+                      }) {
+            using hash_t = decltype(map_.hash(std::declval<const key_t&>()));
+            auto hashes = std::vector<hash_t>{};
+            for (auto& key : keys)
+                map_.prefetch(hashes.emplace_back(map_.hash(key)));
+            auto hash = hashes.begin();
+            for (auto& key : keys)
+                *result++ = visit(key, map_.find(key, *hash++));
+        }
+        else
+            for (auto& key : keys)
+                *result++ = find(key);
+        return result;
+    }
+
+    /// @param items - range of key-value pairs,
+    ///                elements of the owning rvalue range are moved from
+    template <std::ranges::input_range R>
+    void insert_many(R&& items)
+    {
+        for (auto&& [key, val] : items)
+            if constexpr (movable_elements_v<R>)
+                insert_or_assign(std::move(key), std::move(val));
+            else
+                insert_or_assign(key, val);
+    }
+
+    /// Item is not touched.
     /// @return nullptr if key is not found
-    const T* find(const Key& key)
+    template <class K>
+    const T* peek(const K& key)
+    {
+        auto it = map_.find(key);
+        return it == map_.end() ? nullptr : std::addressof(it->second);
+    }
+
+    /// Write items from the least to the most recently used.
+    template <class KeyCodec = codec<Key>, class ValueCodec = codec<T>>
+    void save(std::ostream& os,
+              const KeyCodec& key_codec = {},
+              const ValueCodec& val_codec = {}) const
+    {
+        codec<uint64_t>::encode(os, map_.size());
+        map_.for_each([&](auto& item) {
+            key_codec.encode(os, item.first);
+            val_codec.encode(os, item.second);
+        });
+    }
+
+    /// Items are inserted in the saved order, so recency is restored
+    /// and the least recently used ones are evicted if capacity is less.
+    /// Existing items keep their values.
+    template <class KeyCodec = codec<Key>, class ValueCodec = codec<T>>
+    void load(std::istream& is,
+              const KeyCodec& key_codec = {},
+              const ValueCodec& val_codec = {})
+    {
+        for (auto n = codec<uint64_t>::decode(is); n; --n) {
+            auto key = key_codec.decode(is);
+            try_emplace(std::move(key), val_codec.decode(is));
+        }
+    }
+
+    /// @return false if key is not found
+    template <class K>
+    bool erase(const K& key)
     {
         auto it = map_.find(key);
         if (it == map_.end())
+            return false;
+        observer_.on_erase(std::as_const(it->first), std::as_const(it->second));
+        weight_ -= weigh(it);
+        map_.erase(it);
+        return true;
+    }
+
+    /// Basic exception guarantee.
+    /// Inserted item remains if an exception occurs.
+    /// Existing item is erased if the new value is too heavy.
+    template <class K, class M>
+    void insert_or_assign(K&& key, M&& val)
+    {
+        auto result = emplace(
+            max_weight_, 0, std::forward<K>(key), std::forward<M>(val));
+        if (!result || result->second)
+            return;
+        auto it = result->first;
+        weight_ -= weigh(it);
+        try {
+            it->second = std::forward<M>(val);
+        }
+        catch (...) {
+            weight_ += weigh(it);
+            throw;
+        }
+        if (auto weight = weigh(it); weight > max_weight_)
+            map_.erase(it);
+        else
+            charge(weight, 0);
+    }
+
+    /// Arguments are not moved from if the key exists.
+    /// @return false if key exists or the item is too heavy
+    template <class K, class... Args>
+    bool try_emplace(K&& key, Args&&... args)
+    {
+        auto result = emplace(max_weight_,
+                              0,
+                              std::forward<K>(key),
+                              std::forward<Args>(args)...);
+        return result && result->second;
+    }
+
+    /// Factory is called to construct the value in place if key is not found.
+    /// Strong exception guarantee if the factory throws.
+    /// The value is never rejected since a reference to it is returned,
+    /// it is kept until the next insertion even if capacity is zero.
+    template <class K, class F>
+    const T& get_or_insert_with(K&& key, F&& factory)
+    {
+        if constexpr (!deferrable_v<T>)
+            if (auto it = map_.find(key); it != map_.end())
+                return *visit(key, it);
+        auto [it, success] = *emplace(
+            SIZE_MAX, 1, std::forward<K>(key), in_place_arg<T>(factory));
+        if (success)
+            observer_.on_miss(std::as_const(it->first));
+        else
+            observer_.on_hit(std::as_const(it->first));
+        return it->second;
+    }
+
+private:
+    template <class K>
+    const T* visit(const K& key, iterator it)
+    {
+        if (it == map_.end()) {
+            observer_.on_miss(key);
             return nullptr;
+        }
+        observer_.on_hit(key);
         map_.transfer(it, map_.end());
         return std::addressof(it->second);
     }
 
-    /// Basic exception guarantee.
-    /// Inserted item remains if an exception occurs.
-    void insert_or_assign(const Key& key, const T& val)
+    std::size_t weigh(iterator it) const
+    {
+        return Weigher{}(std::as_const(it->first), std::as_const(it->second));
+    }
+
+    /// Evict the least recently used items down to the given number.
+    void charge(std::size_t weight, std::size_t keep)
+    {
+        weight_ += weight;
+        while (weight_ > capacity_ && map_.size() > keep) {
+            auto it = map_.begin();
+            weight_ -= weigh(it);
+            observer_.on_evict(std::as_const(it->first),
+                               std::as_const(it->second));
+            map_.erase(it);
+        }
+    }
+
+    /// @param keep - number of the most recent items that are not evicted
+    /// @return std::nullopt if the item is too heavy or does not fit
+    template <class K, class... Args>
+    auto emplace(std::size_t max_weight,
+                 std::size_t keep,
+                 K&& key,
+                 Args&&... args) -> std::optional<std::pair<iterator, bool>>
     {
-        auto [it, success] = map_.emplace(map_.end(), key, val);
+        auto [it, success] = map_.try_emplace(
+            map_.end(), std::forward<K>(key), std::forward<Args>(args)...);
         if (!success) {
             map_.transfer(it, map_.end());
-            it->second = val;
+            return std::pair{it, false};
+        }
+        auto weight = weigh(it);
+        if (weight > max_weight) {
+            map_.erase(it);
+            return std::nullopt;
+        }
+        charge(weight, keep);
+        if (!map_.size())
+            return std::nullopt;
+        return std::pair{it, true};
+    }
+};
+
+/// LRU cache that does not allocate after construction.
+
+/// Capacity must be less than 2^31.
+template <class Key,
+          class T,
+          class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class Weigher = unit_weigher,
+          class Observer = null_observer>
+using flat_cache =
+    cache<Key,
+          T,
+          Hash,
+          KeyEqual,
+          Weigher,
+          Observer,
+          detail::flat_linked_hash_map<Key, T, Hash, KeyEqual>>;
+
+/// CLOCK approximation of LRU, a hit only sets the reference bit.
+
+/// Since find is const and atomic, concurrent readers may share a lock.
+/// The hand evicts the first unreferenced item, resetting bits on its way.
+template <class Key,
+          class T,
+          class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>>
+class clock_cache {
+    struct slot_type {
+        std::optional<std::pair<const Key, T>> item;
+        mutable std::atomic_bool referenced;
+    };
+
+    std::deque<slot_type> slots_;
+    std::unordered_map<Key, std::size_t, Hash, KeyEqual> map_;
+    std::size_t capacity_;
+    std::size_t hand_ = 0;
+
+    std::size_t evict()
+    {
+        for (;; hand_ = (hand_ + 1) % slots_.size()) {
+            auto& slot = slots_[hand_];
+            if (slot.item &&
+                slot.referenced.exchange(false, std::memory_order_relaxed))
+                continue;
+            if (slot.item) {
+                map_.erase(slot.item->first);
+                slot.item.reset();
+            }
+            return std::exchange(hand_, (hand_ + 1) % slots_.size());
+        }
+    }
+
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    explicit clock_cache(std::size_t capacity) : capacity_(capacity) {}
+    clock_cache(clock_cache&&) = default;
+    clock_cache& operator=(clock_cache&&) = default;
+    clock_cache(const clock_cache&) = delete;
+    clock_cache& operator=(const clock_cache&) = delete;
+    virtual ~clock_cache() = default;
+
+    /// Thread-safe against other find calls.
+    /// @return nullptr if key is not found
+    const T* find(const Key& key) const
+    {
+        auto it = map_.find(key);
+        if (it == map_.end())
+            return nullptr;
+        auto& slot = slots_[it->second];
+        if (!slot.referenced.load(std::memory_order_relaxed))
+            slot.referenced.store(true, std::memory_order_relaxed);
+        return std::addressof(slot.item->second);
+    }
+
+    /// Basic exception guarantee.
+    /// Evicted item is not restored if an exception occurs.
+    void insert_or_assign(const Key& key, const T& val)
+    {
+        if (auto it = map_.find(key); it != map_.end()) {
+            auto& slot = slots_[it->second];
+            slot.item->second = val;
+            slot.referenced.store(true, std::memory_order_relaxed);
             return;
         }
-        while (map_.size() > capacity_)
-            map_.erase(map_.begin());
+        if (!capacity_)
+            return;
+        auto pos = slots_.size();
+        if (pos < capacity_)
+            slots_.emplace_back();
+        else
+            pos = evict();
+        auto& slot = slots_[pos];
+        slot.item.emplace(key, val);
+        try {
+            map_.emplace(key, pos);
+        }
+        catch (...) {
+            slot.item.reset();
+            throw;
+        }
+        slot.referenced.store(false, std::memory_order_relaxed);
     }
 };
 
@@ -0,0 +1,108 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_LOADING_CACHE_HPP
+#define STEP20_LOADING_CACHE_HPP
+
+#include "expiring_cache.hpp"
+#include <chrono>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace step20 {
+
+/// Thread-safe cache that loads missing values with single flight.
+
+/// Concurrent misses on the same key wait for one call of the loader.
+/// Failed loads are remembered for a while and rethrown without a call.
+/// @param Cache - single-threaded cache, e.g. least_recently_used::cache.
+/// @param Loader - function that returns Cache::mapped_type for a key.
+template <class Cache, class Loader, class Clock = std::chrono::steady_clock>
+class loading_cache {
+public:
+    using key_type = typename Cache::key_type;
+    using mapped_type = typename Cache::mapped_type;
+    using hasher = typename Cache::hasher;
+    using key_equal = typename Cache::key_equal;
+    using duration = typename Clock::duration;
+
+    /// @param negative_ttl - time to remember a failure
+    loading_cache(std::size_t capacity, Loader loader, duration negative_ttl)
+        : cache_(capacity)
+        , failures_(capacity, negative_ttl)
+        , loader_(std::move(loader))
+    {
+    }
+
+    loading_cache(const loading_cache&) = delete;
+    loading_cache& operator=(const loading_cache&) = delete;
+    virtual ~loading_cache() = default;
+
+    /// Exception of the loader is propagated to all waiting callers.
+    /// Exception of the cache is propagated to the loading caller only.
+    /// @return copy of the value since it can be evicted by another thread
+    mapped_type get(const key_type& key)
+    {
+        auto lock = std::unique_lock{guard_};
+        if (auto ptr = cache_.find(key))
+            return *ptr;
+        if (auto ptr = failures_.find(key))
+            std::rethrow_exception(*ptr);
+        if (auto it = pending_.find(key); it != pending_.end()) {
+            auto future = it->second;
+            lock.unlock();
+            return future.get();
+        }
+        auto promise = std::promise<mapped_type>{};
+        pending_.emplace(key, promise.get_future().share());
+        lock.unlock();
+        auto val = std::optional<mapped_type>{};
+        auto error = std::exception_ptr{};
+        try {
+            val.emplace(loader_(key));
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        try {  ///< waiters are released before the caches are updated
+            if (val)
+                promise.set_value(*val);
+            else
+                promise.set_exception(error);
+        }
+        catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+        lock.lock();
+        pending_.erase(key);
+        if (val)
+            cache_.insert_or_assign(key, *val);
+        else
+            failures_.insert_or_assign(key, error);
+        lock.unlock();
+        if (!val)
+            std::rethrow_exception(error);
+        return std::move(*val);
+    }
+
+private:
+    using future_type = std::shared_future<mapped_type>;
+    using failures_type = expiring_cache<key_type,
+                                         std::exception_ptr,
+                                         least_recently_used::cache,
+                                         hasher,
+                                         key_equal,
+                                         Clock>;
+
+    std::mutex guard_;
+    Cache cache_;
+    failures_type failures_;
+    std::unordered_map<key_type, future_type, hasher, key_equal> pending_;
+    Loader loader_;
+};
+
+}  // namespace step20
+
+#endif  // STEP20_LOADING_CACHE_HPP
@@ -3,7 +3,9 @@
 #ifndef STEP20_LONGEST_COMMON_SUBSEQUENCE_HPP
 #define STEP20_LONGEST_COMMON_SUBSEQUENCE_HPP
 
+#include "detail/bit_parallel.hpp"
 #include "detail/hirschberg.hpp"
+#include "detail/myers.hpp"
 #include "detail/utility.hpp"
 #include <cstdint>
 
@@ -66,6 +68,72 @@ O copy(const R1& r1, const R2& r2, O result, const Equal& eq = {})
                              result);
 }
 
+/// Find the ranges of two sequences that are out of the longest subsequence.
+
+/// Writes pairs of std::ranges::subrange - hunks in ascending order.
+/// Time complexity O((N+M)*D), space complexity O(N+M), where:
+/// N = std::ranges::distance(r1), M = std::ranges::distance(r2),
+/// D - size of the shortest edit script.
+/// @see https://doi.org/10.1007/BF01840446
+template <std::ranges::random_access_range R1,
+          std::ranges::random_access_range R2,
+          std::weakly_incrementable O,
+          class Equal = std::equal_to<>>
+O diff(const R1& r1, const R2& r2, O result, const Equal& eq = {})
+{
+    return myers::trace(eq,
+                        std::ranges::begin(r1),
+                        std::ranges::end(r1),
+                        std::ranges::begin(r2),
+                        std::ranges::end(r2),
+                        result);
+}
+
+/// Find the length of the longest subsequence present in two sequences.
+
+/// Bit-parallel algorithm, elements are compared with std::equal_to.
+/// Time complexity O(ceil(N/W)*M), space complexity O(N+K), where:
+/// N = std::ranges::distance(r1), M = std::ranges::distance(r2),
+/// W - machine word size, K - alphabet size.
+template <std::ranges::forward_range R1, std::ranges::forward_range R2>
+std::size_t length(const R1& r1, const R2& r2)
+{
+    return *bit_parallel::lcs_length(bit_parallel::pattern{r1}, r2);
+}
+
+/// Find the lengths of the longest subsequences of the query and candidates.
+
+/// Candidates are processed in parallel, the query is preprocessed once.
+/// @return std::nullopt for lengths less than min_length
+template <std::ranges::forward_range R, std::ranges::random_access_range Rs>
+auto lengths(const R& query, const Rs& candidates, std::size_t min_length = 0)
+    -> std::vector<std::optional<std::size_t>>
+{
+    return bit_parallel::one_vs_many(
+        [=](const auto& pat, const auto& str) {
+            return bit_parallel::lcs_length(pat, str, min_length);
+        },
+        query,
+        candidates);
+}
+
+/// Find the lengths of the longest subsequences of each pair of sequences.
+
+/// Rows are processed in parallel.
+/// @return symmetric N*N matrix in row-major order, where:
+/// N = std::ranges::distance(strs);
+/// std::nullopt for lengths less than min_length
+template <std::ranges::random_access_range Rs>
+auto lengths(const Rs& strs, std::size_t min_length = 0)
+    -> std::vector<std::optional<std::size_t>>
+{
+    return bit_parallel::all_pairs(
+        [=](const auto& pat, const auto& str) {
+            return bit_parallel::lcs_length(pat, str, min_length);
+        },
+        strs);
+}
+
 }  // namespace step20::longest_common_subsequence
 
 #endif  // STEP20_LONGEST_COMMON_SUBSEQUENCE_HPP
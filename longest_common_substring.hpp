@@ -4,6 +4,7 @@
 #define STEP20_LONGEST_COMMON_SUBSTRING_HPP
 
 #include "suffix_array.hpp"
+#include "suffix_automaton.hpp"
 #include <limits>
 
 namespace step20::longest_common_substring {
@@ -62,6 +63,20 @@ O copy(const R1& r1, const R2& r2, O result, const Compare& comp = {})
     return detail::copy(std::move(str), mid, comp, result);
 }
 
+/// Find the longest substring of the indexed text and the range.
+
+/// Streaming mode: only the text is indexed, the range is scanned once.
+/// Time complexity O(M*log(K)), where:
+/// M = std::ranges::distance(r), K - alphabet size.
+/// @see suffix_automaton is built over the text in O(N*log(K)).
+template <class... Ts, std::ranges::input_range R, std::weakly_incrementable O>
+O copy(const suffix_automaton<Ts...>& dawg, R&& r, O result)
+{
+    auto [first, last] = dawg.longest_common_substring(r);
+    return std::ranges::copy(dawg.data() + first, dawg.data() + last, result)
+        .out;
+}
+
 }  // namespace step20::longest_common_substring
 
 #endif  // STEP20_LONGEST_COMMON_SUBSTRING_HPP
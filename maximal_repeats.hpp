@@ -0,0 +1,123 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_MAXIMAL_REPEATS_HPP
+#define STEP20_MAXIMAL_REPEATS_HPP
+
+#include "detail/parallel.hpp"
+#include "suffix_array.hpp"
+#include <algorithm>
+#include <optional>
+#include <set>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace step20 {
+namespace detail {
+
+/// Left context of the suffixes in lcp-interval.
+template <class Char>
+struct left_context {
+    std::optional<Char> ch;  ///< preceding character shared by suffixes
+    bool diverse = false;    ///< characters differ or text start is met
+    bool leaf = false;
+    bool nested = false;  ///< has child intervals
+};
+
+/// Report repeats of each top-level interval in parallel.
+
+/// Filter(lcp_interval, left_context&) selects intervals to report.
+template <class... Ts, class Filter, std::weakly_incrementable O>
+O repeats(const enhanced_suffix_array<Ts...>& arr,
+          std::size_t min_length,
+          const Filter& filter,
+          O result)
+{
+    using char_t = typename enhanced_suffix_array<Ts...>::value_type;
+    using size_type = typename enhanced_suffix_array<Ts...>::size_type;
+    using context_t = left_context<char_t>;
+    using repeat_t = std::pair<std::basic_string_view<char_t>, size_type>;
+    auto eq = equivalence_fn(arr.comp());
+    auto lcp = arr.lcp_array();
+    auto bounds = std::vector<size_type>{0};
+    for (size_type i = 0; i + 1 < arr.size(); ++i)
+        if (lcp[i] == 0)
+            bounds.push_back(i + 1);
+    bounds.push_back(arr.size());
+    auto leaf = [&](size_type rank) {
+        auto pos = arr[rank];
+        return pos ? context_t{arr.data()[pos - 1], false, true}
+                   : context_t{std::nullopt, true, true};
+    };
+    auto merge = [&](context_t& parent, context_t&& child) {
+        parent.nested |= !child.leaf;
+        parent.diverse |= child.diverse ||
+                          (parent.ch && child.ch && !eq(*parent.ch, *child.ch));
+        if (!parent.ch)
+            parent.ch = child.ch;
+    };
+    auto found = std::vector<std::vector<repeat_t>>(bounds.size() - 1);
+    parallel_for(found.size(), [&](std::size_t i) {
+        auto visit = [&](auto in, auto& ctx) {
+            if (in.lcp < min_length || !filter(in, ctx))
+                return;
+            auto first = arr.data() + arr[in.first];
+            found[i].emplace_back(std::basic_string_view{first, in.lcp},
+                                  size_type(in.last - in.first));
+        };
+        arr.bottom_up(bounds[i], bounds[i + 1], leaf, merge, visit);
+    });
+    for (auto& vec : found)
+        result = std::ranges::copy(vec, result).out;
+    return result;
+}
+
+}  // namespace detail
+
+/// Find repeats that can not be extended to the left or right.
+
+/// Output is pairs of substring and number of its occurrences.
+/// Time complexity O(N), where: N - text length.
+/// Top-level intervals are traversed in parallel.
+template <class... Ts, std::weakly_incrementable O>
+O maximal_repeats(const enhanced_suffix_array<Ts...>& arr,
+                  std::size_t min_length,
+                  O result)
+{
+    return detail::repeats(
+        arr,
+        min_length,
+        [](auto&, auto& ctx) { return ctx.diverse; },
+        result);
+}
+
+/// Find maximal repeats that do not occur in other maximal repeats.
+
+/// Output is pairs of substring and number of its occurrences.
+/// Time complexity O(N*log(K)), where: N - text length, K - alphabet size.
+/// Left contexts of a leaf interval are counted until the first repeat.
+/// Top-level intervals are traversed in parallel.
+template <class... Ts, std::weakly_incrementable O>
+O supermaximal_repeats(const enhanced_suffix_array<Ts...>& arr,
+                       std::size_t min_length,
+                       O result)
+{
+    using char_t = typename enhanced_suffix_array<Ts...>::value_type;
+    auto filter = [&](auto& in, auto& ctx) {
+        if (ctx.nested || !ctx.diverse)
+            return false;
+        using comp_t = std::remove_cvref_t<decltype(arr.comp())>;
+        auto chars = std::set<char_t, comp_t>(arr.comp());
+        for (auto rank = in.first; rank < in.last; ++rank)
+            if (auto pos = arr[rank])
+                if (!chars.insert(arr.data()[pos - 1]).second)
+                    return false;  ///< at most K + 1 characters are seen
+        return true;
+    };
+    return detail::repeats(arr, min_length, filter, result);
+}
+
+}  // namespace step20
+
+#endif  // STEP20_MAXIMAL_REPEATS_HPP
@@ -0,0 +1,163 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_SHARDED_CACHE_HPP
+#define STEP20_SHARDED_CACHE_HPP
+
+#include "detail/cache_observer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace step20 {
+
+/// Thread-safe cache of independently locked shards chosen by key hash.
+
+/// Throughput scales with cores as long as keys are spread evenly.
+/// @param Cache - single-threaded cache, e.g. least_recently_used::cache.
+template <class Cache>
+class sharded_cache {
+public:
+    using key_type = typename Cache::key_type;
+    using mapped_type = typename Cache::mapped_type;
+    using hasher = typename Cache::hasher;
+
+    /// @param capacity - total capacity, it is divided between shards
+    explicit sharded_cache(
+        std::size_t capacity,
+        std::size_t shards = std::thread::hardware_concurrency())
+    {
+        shards = std::max<std::size_t>(1, shards);
+        for (std::size_t i = 0; i < shards; ++i)
+            shards_.emplace_back(capacity / shards + (i < capacity % shards));
+    }
+
+    sharded_cache(const sharded_cache&) = delete;
+    sharded_cache& operator=(const sharded_cache&) = delete;
+    virtual ~sharded_cache() = default;
+
+    /// Readers share a lock if the cache supports const find.
+    /// @return copy of the value, std::nullopt if key is not found
+    std::optional<mapped_type> find(const key_type& key)
+    {
+        auto& shard = at(key);
+        auto lock = lock_type{shard.guard};
+        if (auto ptr = shard.cache.find(key))
+            return *ptr;
+        return std::nullopt;
+    }
+
+    void insert_or_assign(const key_type& key, const mapped_type& val)
+    {
+        auto& shard = at(key);
+        auto lock = std::lock_guard{shard.guard};
+        shard.cache.insert_or_assign(key, val);
+    }
+
+    /// @return false if key is not found
+    bool erase(const key_type& key)
+    {
+        auto& shard = at(key);
+        auto lock = std::lock_guard{shard.guard};
+        return shard.cache.erase(key);
+    }
+
+    /// Sum of the statistics of shards, each shard is locked in turn.
+    step20::statistics<> stats() const
+        requires requires(const Cache& cache) { cache.observer().erasures; }
+    {
+        auto result = step20::statistics<>{};
+        for (auto& shard : shards_) {
+            auto lock = std::lock_guard{shard.guard};
+            auto& observer = shard.cache.observer();
+            result.hits += observer.hits;
+            result.misses += observer.misses;
+            result.evictions += observer.evictions;
+            result.erasures += observer.erasures;
+        }
+        return result;
+    }
+
+    /// Each shard is locked once per batch.
+    /// @return copies of the values in the order of keys
+    template <std::ranges::random_access_range R>
+    std::vector<std::optional<mapped_type>> find_many(const R& keys)
+    {
+        auto first = std::ranges::begin(keys);
+        auto result = std::vector<std::optional<mapped_type>>(
+            std::ranges::distance(keys));
+        for_each_shard(keys, [&](shard_type& shard, auto& positions) {
+            auto lock = lock_type{shard.guard};
+            for (auto i : positions)
+                if (auto ptr = shard.cache.find(first[i]))
+                    result[i] = *ptr;
+        });
+        return result;
+    }
+
+    /// Each shard is locked once per batch.
+    /// @param items - range of key-value pairs
+    template <std::ranges::random_access_range R>
+    void insert_many(const R& items)
+    {
+        auto first = std::ranges::begin(items);
+        for_each_shard(items | std::views::keys,
+                       [&](shard_type& shard, auto& positions) {
+                           auto lock = std::lock_guard{shard.guard};
+                           for (auto i : positions) {
+                               auto& [key, val] = first[i];
+                               shard.cache.insert_or_assign(key, val);
+                           }
+                       });
+    }
+
+private:
+    static constexpr bool shared_v =
+        requires(const Cache& cache, const key_type& key) { cache.find(key); };
+    using mutex_type =
+        std::conditional_t<shared_v, std::shared_mutex, std::mutex>;
+    using lock_type = std::conditional_t<shared_v,
+                                         std::shared_lock<mutex_type>,
+                                         std::lock_guard<mutex_type>>;
+
+    struct alignas(64) shard_type {
+        mutable mutex_type guard;
+        Cache cache;
+        explicit shard_type(std::size_t capacity) : cache(capacity) {}
+    };
+
+    std::deque<shard_type> shards_;
+
+    /// Call fn(shard, positions of its keys) for each shard in use.
+    template <class R, class F>
+    void for_each_shard(const R& keys, F fn)
+    {
+        auto positions = std::vector<std::vector<std::size_t>>(shards_.size());
+        std::size_t i = 0;
+        for (auto& key : keys)
+            positions[index(key)].push_back(i++);
+        for (i = 0; i < shards_.size(); ++i)
+            if (!positions[i].empty())
+                fn(shards_[i], positions[i]);
+    }
+
+    /// Fibonacci hashing, most significant bits select the shard,
+    /// so they do not correlate with buckets of the flat cache.
+    std::size_t index(const key_type& key) const
+    {
+        auto hash = ((uint64_t)hasher{}(key) * 0x9e3779b97f4a7c15ull) >> 32;
+        return (hash * shards_.size()) >> 32;
+    }
+
+    shard_type& at(const key_type& key) { return shards_[index(key)]; }
+};
+
+}  // namespace step20
+
+#endif  // STEP20_SHARDED_CACHE_HPP
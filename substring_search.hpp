@@ -36,6 +36,27 @@ auto find_all(const suffix_array<Ts...>& arr,
         co_yield pos;
 }
 
+/// Find all occurrences of the substring in batches.
+
+/// Batches are slices of the suffix array, nothing is copied.
+/// Zero batch size is treated as one.
+template <class... Ts>
+auto find_all_batched(
+    const suffix_array<Ts...>& arr,
+    std::basic_string<typename suffix_array<Ts...>::value_type> str,
+    std::size_t batch_size)
+    -> generator<std::span<const typename suffix_array<Ts...>::size_type>>
+{
+    if (std::ranges::empty(str)) {
+        auto size = arr.size();
+        co_yield std::span{&size, 1};
+    }
+    batch_size = std::max<std::size_t>(batch_size, 1);
+    auto all = arr.find(str);
+    for (std::size_t i = 0; i < all.size(); i += batch_size)
+        co_yield all.subspan(i, std::min(batch_size, all.size() - i));
+}
+
 /// Find offset of the first occurrence of the substring.
 
 /// Time complexity O(M), where: M - substring length.
@@ -67,6 +88,38 @@ auto find_all(const suffix_tree<Ts...>& tree,
                 co_yield tree.labels(edge).first;
 }
 
+/// Find all occurrences of the substring in batches.
+
+/// Coroutines are resumed once per batch rather than per occurrence.
+/// Zero batch size is treated as one.
+template <class... Ts>
+auto find_all_batched(
+    const suffix_tree<Ts...>& tree,
+    std::basic_string<typename suffix_tree<Ts...>::value_type> str,
+    std::size_t batch_size)
+    -> generator<std::span<const typename suffix_tree<Ts...>::size_type>>
+{
+    if (std::ranges::empty(str)) {
+        auto size = tree.size();
+        co_yield std::span{&size, 1};
+    }
+    batch_size = std::max<std::size_t>(batch_size, 1);
+    auto batch = std::vector<typename suffix_tree<Ts...>::size_type>{};
+    batch.reserve(batch_size);
+    if (auto start = tree.find(str))
+        for (auto edges : tree.depth_first_search(*start, batch_size))
+            for (auto& edge : edges)
+                if (tree.leaf(edge.child_node)) {
+                    batch.push_back(tree.labels(edge).first);
+                    if (batch.size() >= batch_size) {
+                        co_yield batch;
+                        batch.clear();
+                    }
+                }
+    if (!batch.empty())
+        co_yield batch;
+}
+
 }  // namespace step20::substring_search
 
 #endif  // STEP20_SUBSTRING_SEARCH_HPP
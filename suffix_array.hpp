@@ -4,9 +4,15 @@
 #define STEP20_SUFFIX_ARRAY_HPP
 
 #include "to.hpp"
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <optional>
 #include <span>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace step20 {
 
@@ -16,10 +22,13 @@ namespace step20 {
 /// N - text length.
 /// @param Char - type of the characters;
 /// @param Size - to specify the maximum number / offset of characters;
-/// @param Compare - to determine the order of characters.
+/// @param Compare - to determine the order of characters;
+/// @param Text - owning std::basic_string or std::basic_string_view
+///               to the text that outlives the array (e.g. file_view).
 template <class Char,
           std::unsigned_integral Size = std::size_t,
-          class Compare = std::less<>>
+          class Compare = std::less<>,
+          class Text = std::basic_string<Char>>
 class suffix_array {
 public:
     using value_type = Char;
@@ -30,7 +39,7 @@ public:
     const Compare& comp() const { return comp_; }
     virtual ~suffix_array() = default;
 
-    explicit suffix_array(std::basic_string<Char> str, const Compare& comp = {})
+    explicit suffix_array(Text str, const Compare& comp = {})
         : str_(std::move(str)), pos_(size()), comp_(comp)
     {
         auto sufs = std::vector<suffix>(size());
@@ -48,8 +57,9 @@ public:
     }
 
     template <std::ranges::input_range R>
+        requires(!std::ranges::view<Text>)
     explicit suffix_array(R&& r, const Compare& comp = {})
-        : suffix_array(to<std::basic_string>(std::forward<R>(r)), comp)
+        : suffix_array(to<Text>(std::forward<R>(r)), comp)
     {
     }
 
@@ -70,8 +80,11 @@ public:
         return result;
     }
 
+protected:
+    std::span<const Size> positions() const { return pos_; }
+
 private:
-    std::basic_string<Char> str_;
+    Text str_;
     std::vector<Size> pos_;
     Compare comp_;
 
@@ -113,47 +126,107 @@ template <std::ranges::input_range R, class Compare = std::less<>>
 suffix_array(R, Compare = {})
     -> suffix_array<std::ranges::range_value_t<R>, std::size_t, Compare>;
 
-/// Kasai's algorithm for constructing longest common prefix array.
+/// Kärkkäinen's permuted LCP (Phi) algorithm for longest common prefix array.
 
-/// Time and space complexity O(N), where: N - text length.
+/// Phi and permuted LCP are computed in place of the result,
+/// so the peak memory is N words of the result and N bits, unlike Kasai's
+/// algorithm that needs N more words for the inverse suffix array.
+/// Text is scanned in its own order rather than in the order of ranks.
+/// Time complexity O(N), where: N - text length.
 template <class Char,
           std::unsigned_integral Size = std::size_t,
-          class Compare = std::less<>>
-class enhanced_suffix_array : public suffix_array<Char, Size, Compare> {
+          class Compare = std::less<>,
+          class Text = std::basic_string<Char>>
+class enhanced_suffix_array : public suffix_array<Char, Size, Compare, Text> {
+    using base_type = suffix_array<Char, Size, Compare, Text>;
     std::vector<Size> lcp_;
 
 public:
     std::span<const Size> lcp_array() const { return lcp_; }
 
-    explicit enhanced_suffix_array(suffix_array<Char, Size, Compare>&& arr)
-        : suffix_array<Char, Size, Compare>(std::move(arr)), lcp_(this->size())
+    explicit enhanced_suffix_array(base_type&& arr)
+        : base_type(std::move(arr)), lcp_(this->size())
     {
         const auto& me = *this;
-        auto inv = std::vector<Size>(me.size());
-        for (Size i = 0; i < me.size(); ++i)
-            inv[me[i]] = i;
+        auto n = me.size();
+        for (Size i = 0; i < n; ++i)
+            lcp_[me[i]] = i + 1 < n ? me[i + 1] : n;  ///< Phi of next rank
         auto first = me.data();
-        auto last = first + me.size();
+        auto last = first + n;
         auto eq = equivalence_fn(me.comp());
-        for (Size i = 0, lcp = 0; i < me.size(); ++i, lcp -= !!lcp) {
-            Size cur = inv[i];
-            if (Size next = cur + 1; next < me.size()) {
+        for (Size i = 0, lcp = 0; i < n; ++i, lcp -= !!lcp) {
+            if (Size next = lcp_[i]; next < n) {
                 auto diff = std::mismatch(
-                    first + i + lcp, last, first + me[next] + lcp, last, eq);
+                    first + i + lcp, last, first + next + lcp, last, eq);
                 lcp = diff.first - (first + i);
             }
             else
                 lcp = 0;
-            lcp_[cur] = lcp;
+            lcp_[i] = lcp;  ///< permuted LCP
+        }
+        auto done = std::vector<bool>(n);
+        for (Size i = 0; i < n; ++i) {  ///< permute cycles to ranks
+            if (done[i])
+                continue;
+            auto val = lcp_[i];
+            auto cur = i;
+            for (Size pos = me[cur]; pos != i; cur = pos, pos = me[cur]) {
+                lcp_[cur] = lcp_[pos];
+                done[cur] = true;
+            }
+            lcp_[cur] = val;
+            done[cur] = true;
         }
     }
 
     template <std::ranges::input_range R>
     explicit enhanced_suffix_array(R&& r, const Compare& comp = {})
-        : enhanced_suffix_array(
-              suffix_array<Char, Size, Compare>(std::forward<R>(r), comp))
+        : enhanced_suffix_array(base_type(std::forward<R>(r), comp))
     {
     }
+
+    /// Suffixes of ranks [first, last) share prefix of length lcp.
+    struct lcp_interval {
+        Size lcp, first, last;
+    };
+
+    /// Bottom-up traversal of lcp-intervals, children before parents.
+
+    /// Time complexity O(N), where: N - number of ranks.
+    /// Value of each interval starts with T{} and accumulates its children:
+    /// leaf(rank) -> T, merge(T& parent, T&& child), visit(lcp_interval, T&).
+    /// Intervals are bounded by the range of ranks,
+    /// the range of a top-level interval (lcp of zero) is self-contained.
+    template <class Leaf, class Merge, class Visit>
+    void bottom_up(Size first,
+                   Size last,
+                   Leaf leaf,
+                   Merge merge,
+                   Visit visit) const
+    {
+        using value_t = std::invoke_result_t<Leaf&, Size>;
+        struct node_type {
+            Size lcp, first;
+            value_t val;
+        };
+        auto stack = std::vector<node_type>{};
+        stack.push_back({0, first, {}});
+        for (auto i = first; i < last; ++i) {
+            auto child = node_type{0, i, leaf(i)};
+            auto lcp = i + 1 < last ? lcp_[i] : Size{};
+            while (lcp < stack.back().lcp) {
+                auto node = std::move(stack.back());
+                stack.pop_back();
+                merge(node.val, std::move(child.val));
+                visit(lcp_interval{node.lcp, node.first, Size(i + 1)},
+                      node.val);
+                child = std::move(node);
+            }
+            if (lcp > stack.back().lcp)
+                stack.push_back({lcp, child.first, {}});
+            merge(stack.back().val, std::move(child.val));
+        }
+    }
 };
 
 template <std::ranges::input_range R, class Compare = std::less<>>
@@ -162,6 +235,188 @@ enhanced_suffix_array(R, Compare = {})
                              std::size_t,
                              Compare>;
 
+/// Longest common prefix array of bytes with sorted table of overflows.
+
+/// Most values of natural texts fit into a byte, so the resident size is
+/// about N bytes instead of N words, where: N - text length.
+/// Time complexity of access O(1), O(log(K)) for the overflow, where:
+/// K - number of values greater than 254.
+template <std::unsigned_integral Size = std::size_t>
+class compact_lcp_array {
+    static constexpr auto escape = std::numeric_limits<uint8_t>::max();
+    std::vector<uint8_t> bytes_;
+    std::vector<std::pair<Size, Size>> overflow_;  ///< {index, value}
+
+public:
+    using value_type = Size;
+    using size_type = Size;
+    Size size() const { return bytes_.size(); }
+    compact_lcp_array() = default;
+
+    template <std::ranges::input_range R>
+    explicit compact_lcp_array(R&& lcp)
+    {
+        for (Size val : lcp) {
+            if (val >= escape)
+                overflow_.emplace_back(size(), val);
+            bytes_.push_back(val < escape ? uint8_t(val) : escape);
+        }
+        bytes_.shrink_to_fit();
+        overflow_.shrink_to_fit();
+    }
+
+    Size operator[](Size i) const
+    {
+        if (bytes_[i] < escape)
+            return bytes_[i];
+        return std::ranges::lower_bound(
+                   overflow_, i, {}, &std::pair<Size, Size>::first)
+            ->second;
+    }
+};
+
+template <std::ranges::input_range R>
+compact_lcp_array(R&&) -> compact_lcp_array<std::ranges::range_value_t<R>>;
+
+/// Abouelhoda's child table for top-down traversal of lcp-intervals.
+
+/// Values up, down and next l-index are packed into one array.
+/// Time and space complexity of construction O(N), where: N - text length.
+template <class Char,
+          std::unsigned_integral Size = std::size_t,
+          class Compare = std::less<>,
+          class Text = std::basic_string<Char>>
+class child_table_suffix_array
+    : public enhanced_suffix_array<Char, Size, Compare, Text> {
+    using base_type = enhanced_suffix_array<Char, Size, Compare, Text>;
+    std::vector<Size> cld_;
+
+public:
+    using lcp_interval = typename base_type::lcp_interval;
+
+    explicit child_table_suffix_array(base_type&& arr)
+        : base_type(std::move(arr)), cld_(this->size())
+    {
+        auto n = this->size();
+        auto stack = std::vector<Size>{0};
+        for (Size k = 1; k <= n; ++k) {
+            auto last = k;
+            while (height(stack.back()) > height(k)) {
+                last = stack.back();
+                stack.pop_back();
+                auto top = stack.back();
+                if (height(k) <= height(top) && height(top) != height(last))
+                    cld_[top] = last;  ///< down
+            }
+            if (last != k)
+                cld_[k - 1] = last;  ///< up
+            stack.push_back(k);
+        }
+        stack.clear();
+        for (Size k = 1; k < n; ++k) {
+            while (!stack.empty() && height(stack.back()) > height(k))
+                stack.pop_back();
+            if (!stack.empty() && height(stack.back()) == height(k)) {
+                cld_[stack.back()] = k;  ///< next l-index
+                stack.pop_back();
+            }
+            stack.push_back(k);
+        }
+    }
+
+    template <std::ranges::input_range R>
+    explicit child_table_suffix_array(R&& r, const Compare& comp = {})
+        : child_table_suffix_array(base_type(std::forward<R>(r), comp))
+    {
+    }
+
+    lcp_interval root() const { return interval(0, this->size()); }
+
+    /// Child intervals in the order of ranks, singletons are leaves.
+    template <std::weakly_incrementable O>
+    O children(const lcp_interval& in, O result) const
+    {
+        if (in.last - in.first > 1)
+            for (auto first = in.first; first < in.last;) {
+                auto last = next_child(in.first, in.last, first);
+                *result++ = interval(first, last);
+                first = last;
+            }
+        return result;
+    }
+
+    /// Find positions of suffixes starting with substring.
+
+    /// Descends lcp-intervals like suffix tree.
+    /// Time complexity O(M*K), where:
+    /// M - substring length, K - alphabet size.
+    std::span<const Size> find(std::ranges::input_range auto&& str) const
+    {
+        const auto& me = *this;
+        if (me.size() == 0)
+            return {};
+        auto first = std::ranges::begin(str);
+        auto last = std::ranges::end(str);
+        auto eq = equivalence_fn(me.comp());
+        auto in = root();
+        for (Size depth = 0;;) {
+            auto txt = me.data() + me[in.first];
+            for (; depth < in.lcp && first != last; ++depth, ++first)
+                if (!eq(*first, txt[depth]))
+                    return {};
+            if (first == last)
+                return me.positions().subspan(in.first, in.last - in.first);
+            if (in.last - in.first < 2)
+                return {};
+            auto child = std::optional<lcp_interval>{};
+            for (auto lb = in.first; !child && lb < in.last;) {
+                auto rb = next_child(in.first, in.last, lb);
+                if (me[lb] + depth < me.size() &&
+                    eq(*first, me.data()[me[lb] + depth]))
+                    child = interval(lb, rb);
+                lb = rb;
+            }
+            if (!child)
+                return {};
+            in = *child;
+        }
+    }
+
+private:
+    /// LCP of ranks k-1 and k, -1 at the ends.
+    std::ptrdiff_t height(Size k) const
+    {
+        return k == 0 || k >= this->size()
+                   ? std::ptrdiff_t{-1}
+                   : std::ptrdiff_t(this->lcp_array()[k - 1]);
+    }
+
+    /// @return end of the child that starts at rank lb
+    Size next_child(Size first, Size last, Size lb) const
+    {
+        if (lb == first)
+            return height(first) > height(last) ? cld_[first]
+                                                : cld_[last - 1];
+        auto next = cld_[lb];
+        return next > lb && height(next) == height(lb) ? next : last;
+    }
+
+    lcp_interval interval(Size first, Size last) const
+    {
+        if (last - first > 1)
+            return {Size(height(next_child(first, last, first))), first, last};
+        if (first < last)
+            return {Size(this->size() - (*this)[first]), first, last};
+        return {0, first, last};
+    }
+};
+
+template <std::ranges::input_range R, class Compare = std::less<>>
+child_table_suffix_array(R, Compare = {})
+    -> child_table_suffix_array<std::ranges::range_value_t<R>,
+                                std::size_t,
+                                Compare>;
+
 }  // namespace step20
 
 #endif  // STEP20_SUFFIX_ARRAY_HPP
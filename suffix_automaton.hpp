@@ -0,0 +1,176 @@
+// Andrew Naplavkov
+
+#ifndef STEP20_SUFFIX_AUTOMATON_HPP
+#define STEP20_SUFFIX_AUTOMATON_HPP
+
+#include "to.hpp"
+#include <limits>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace step20 {
+
+/// Online construction of the suffix automaton (DAWG).
+
+/// The minimal automaton that accepts all substrings of the text.
+/// Time complexity O(N*log(K)), space complexity O(N), where:
+/// N - text length, K - alphabet size.
+/// There are at most 2N states and 3N transitions.
+/// @param Char - type of the characters;
+/// @param Size - to specify the maximum number / offset of characters;
+/// @param Map - to associate characters with states;
+/// @param Text - owning std::basic_string or std::basic_string_view
+///               to the text that outlives the automaton (e.g. file_view).
+template <class Char,
+          std::unsigned_integral Size = std::size_t,
+          class Map = std::unordered_map<Char, Size>,
+          class Text = std::basic_string<Char>>
+class suffix_automaton {
+public:
+    using value_type = Char;
+    using size_type = Size;
+    const Char* data() const { return str_.data(); }
+    Size size() const { return str_.size(); }
+    std::size_t states() const { return states_.size(); }
+    suffix_automaton() = default;
+    virtual ~suffix_automaton() = default;
+
+    /// Index the referenced text without copying it.
+    explicit suffix_automaton(Text str)
+        requires std::ranges::view<Text>
+    {
+        for (Size n = 1; n <= str.size(); ++n) {
+            str_ = Text{str.data(), n};
+            extend();
+        }
+    }
+
+    void clear() noexcept
+    {
+        str_ = Text{};
+        states_.clear();
+        last_ = 0;
+    }
+
+    /// Basic exception guarantee.
+    /// Content is released if an exception occurs.
+    void push_back(Char ch)
+        requires(!std::ranges::view<Text>)
+    try {
+        str_.push_back(ch);
+        extend();
+    }
+    catch (...) {
+        clear();
+        throw;
+    }
+
+    struct slice_type {
+        Size first, last;  ///< half-open character range
+        Size length() const { return last - first; }
+    };
+
+    /// Find the first occurrence of the substring.
+
+    /// Time complexity O(M*log(K)), where: M - substring length.
+    std::optional<slice_type> find(std::ranges::input_range auto&& str) const
+    {
+        Size state = 0;
+        Size len = 0;
+        for (auto&& ch : str) {
+            if (states_.empty())
+                return std::nullopt;  ///< nonempty substring of empty text
+            auto it = states_[state].next.find(ch);
+            if (it == states_[state].next.end())
+                return std::nullopt;
+            state = it->second;
+            ++len;
+        }
+        auto last = states_.empty() ? Size{} : states_[state].end;
+        return slice_type{Size(last - len), last};
+    }
+
+    /// Find the longest substring of the text that occurs in the range.
+
+    /// Range is scanned once, so it can be a stream.
+    /// Time complexity O(M*log(K)), where: M - range length.
+    /// @return the first occurrence in the text
+    slice_type longest_common_substring(
+        std::ranges::input_range auto&& str) const
+    {
+        auto result = slice_type{};
+        if (states_.empty())
+            return result;
+        Size state = 0;
+        Size len = 0;
+        for (auto&& ch : str) {
+            auto it = states_[state].next.find(ch);
+            while (state && it == states_[state].next.end()) {
+                state = states_[state].link;
+                len = states_[state].len;
+                it = states_[state].next.find(ch);
+            }
+            if (it == states_[state].next.end())
+                continue;
+            state = it->second;
+            if (++len > result.length())
+                result = {Size(states_[state].end - len), states_[state].end};
+        }
+        return result;
+    }
+
+private:
+    struct state_type {
+        Map next;
+        Size len;   ///< length of the longest string in the state
+        Size link;  ///< suffix link
+        Size end;   ///< end of the first occurrence
+    };
+
+    static constexpr Size none = std::numeric_limits<Size>::max();
+    Text str_;
+    std::vector<state_type> states_;
+    Size last_ = 0;  ///< state of the whole text
+
+    /// Blumer's step for the last character of the text.
+    void extend()
+    {
+        if (states_.empty())
+            states_.push_back({{}, 0, none, 0});
+        auto ch = str_[size() - 1];
+        auto cur = (Size)states_.size();
+        states_.push_back({{}, (Size)(states_[last_].len + 1), 0, size()});
+        auto prev = last_;
+        last_ = cur;
+        for (; prev != none; prev = states_[prev].link) {
+            auto [it, success] = states_[prev].next.try_emplace(ch, cur);
+            if (!success)
+                break;
+        }
+        if (prev == none)
+            return;
+        auto next = states_[prev].next.find(ch)->second;
+        if (states_[prev].len + 1 == states_[next].len) {
+            states_[cur].link = next;
+            return;
+        }
+        auto clone = (Size)states_.size();
+        auto copy = states_[next];
+        copy.len = states_[prev].len + 1;
+        states_.push_back(std::move(copy));
+        for (; prev != none; prev = states_[prev].link) {
+            auto it = states_[prev].next.find(ch);
+            if (it == states_[prev].next.end() || it->second != next)
+                break;
+            it->second = clone;
+        }
+        states_[next].link = states_[cur].link = clone;
+    }
+};
+
+}  // namespace step20
+
+#endif  // STEP20_SUFFIX_AUTOMATON_HPP
@@ -5,9 +5,12 @@
 
 #include "generator.hpp"
 #include "to.hpp"
+#include <span>
 #include <stack>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace step20 {
 
@@ -17,10 +20,13 @@ namespace step20 {
 /// N - text length, K - alphabet size.
 /// @param Char - type of the characters;
 /// @param Size - to specify the maximum number / offset of characters;
-/// @param Map - to associate characters with nodes.
+/// @param Map - to associate characters with nodes;
+/// @param Text - owning std::basic_string or std::basic_string_view
+///               to the text that outlives the tree (e.g. file_view).
 template <class Char,
           std::unsigned_integral Size = std::size_t,
-          class Map = std::unordered_map<Char, Size>>
+          class Map = std::unordered_map<Char, Size>,
+          class Text = std::basic_string<Char>>
 class suffix_tree {
 public:
     using value_type = Char;
@@ -28,11 +34,22 @@ public:
     const Char* data() const { return str_.data(); }
     Size size() const { return str_.size(); }
     bool leaf(Size node) const { return node >= nodes_.size(); }
+    suffix_tree() = default;
     virtual ~suffix_tree() = default;
 
+    /// Index the referenced text without copying it.
+    explicit suffix_tree(Text str)
+        requires std::ranges::view<Text>
+    {
+        for (Size n = 1; n <= str.size(); ++n) {
+            str_ = Text{str.data(), n};
+            extend();
+        }
+    }
+
     void clear() noexcept
     {
-        str_.clear();
+        str_ = Text{};
         nodes_.clear();
         pos_ = node_ = 0;
     }
@@ -40,28 +57,10 @@ public:
     /// Basic exception guarantee.
     /// Content is released if an exception occurs.
     void push_back(Char ch)
+        requires(!std::ranges::view<Text>)
     try {
         str_.push_back(ch);
-        if (nodes_.empty())
-            nodes_.emplace_back();
-        auto tie = [this, src = nodes_.size()](Size dest) mutable {
-            if (!leaf(src) && src != dest)
-                nodes_[src++].link = dest;
-        };
-        while (pos_ < size()) {
-            if (Size& node = nodes_[node_].children[str_[pos_]]) {
-                if (skip(node))
-                    continue;
-                if (!split(node))
-                    return tie(node_);
-                tie(nodes_.size() - 1);
-            }
-            else {
-                node = flip(pos_);
-                tie(node_);
-            }
-            node_ ? node_ = nodes_[node_].link : ++pos_;
-        }
+        extend();
     }
     catch (...) {
         clear();
@@ -126,19 +125,32 @@ public:
             auto edge = stack.top();
             co_yield edge;
             stack.pop();
-            if (!leaf(edge.child_node))
-                std::ranges::copy(
-                    try_reverse(nodes_[edge.child_node].children) |
-                        std::views::transform([&](auto&& item) {
-                            return edge_type{
-                                edge.child_node,
-                                item.second,
-                                edge.labels_len + label(item.second).length()};
-                        }),
-                    emplace_iterator(stack));
+            push_children(edge, stack);
         }
     }
 
+    /// Edges are yielded in batches, coroutine is resumed once per batch.
+    /// Zero batch size is treated as one.
+    generator<std::span<const edge_type>> depth_first_search(
+        edge_type start,
+        std::size_t batch_size) const
+    {
+        batch_size = std::max<std::size_t>(batch_size, 1);
+        auto batch = std::vector<edge_type>{};
+        batch.reserve(batch_size);
+        for (auto stack = std::stack<edge_type>{{start}}; !stack.empty();) {
+            batch.push_back(stack.top());
+            stack.pop();
+            push_children(batch.back(), stack);
+            if (batch.size() >= batch_size) {
+                co_yield batch;
+                batch.clear();
+            }
+        }
+        if (!batch.empty())
+            co_yield batch;
+    }
+
 private:
     struct node_type {
         Map children;
@@ -147,10 +159,50 @@ private:
     };
 
     inline static auto eq_ = key_equivalence_fn<Map>();
-    std::basic_string<Char> str_;
+    Text str_;
     std::vector<node_type> nodes_;  ///< inner nodes
     Size pos_{}, node_{};           ///< active point
 
+    void push_children(const edge_type& edge,
+                       std::stack<edge_type>& stack) const
+    {
+        if (!leaf(edge.child_node))
+            std::ranges::copy(
+                try_reverse(nodes_[edge.child_node].children) |
+                    std::views::transform([&](auto&& item) {
+                        return edge_type{
+                            edge.child_node,
+                            item.second,
+                            edge.labels_len + label(item.second).length()};
+                    }),
+                emplace_iterator(stack));
+    }
+
+    /// Ukkonen's phase for the last character of the text.
+    void extend()
+    {
+        if (nodes_.empty())
+            nodes_.emplace_back();
+        auto tie = [this, src = nodes_.size()](Size dest) mutable {
+            if (!leaf(src) && src != dest)
+                nodes_[src++].link = dest;
+        };
+        while (pos_ < size()) {
+            if (Size& node = nodes_[node_].children[str_[pos_]]) {
+                if (skip(node))
+                    continue;
+                if (!split(node))
+                    return tie(node_);
+                tie(nodes_.size() - 1);
+            }
+            else {
+                node = flip(pos_);
+                tie(node_);
+            }
+            node_ ? node_ = nodes_[node_].link : ++pos_;
+        }
+    }
+
     bool skip(Size node)
     {
         Size len = label(node).length();
@@ -1,22 +1,43 @@
 // Andrew Naplavkov
 
+#include <any>
 #include <cctype>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
 #include <random>
+#include <set>
 #include <source_location>
 #include <sstream>
-#include <step20/detail/read_file.hpp>
+#include <thread>
+#include <step20/adaptive_replacement.hpp>
+#include <step20/detail/count_min_sketch.hpp>
+#include <step20/detail/file_view.hpp>
+#include <step20/detail/parallel.hpp>
+#include <step20/detail/timer_wheel.hpp>
 #include <step20/edit_distance.hpp>
+#include <step20/expiring_cache.hpp>
+#include <step20/example/cache_sim/cache_sim.hpp>
 #include <step20/example/diff/diff.hpp>
 #include <step20/example/suffix_tree_viz/suffix_tree_viz.hpp>
 #include <step20/least_frequently_used.hpp>
 #include <step20/least_recently_used.hpp>
+#include <step20/loading_cache.hpp>
 #include <step20/longest_common_subsequence.hpp>
 #include <step20/longest_common_substring.hpp>
 #include <step20/longest_repeated_substring.hpp>
+#include <step20/maximal_repeats.hpp>
+#include <step20/sharded_cache.hpp>
 #include <step20/substring_search.hpp>
 #include <step20/suffix_array.hpp>
+#include <step20/suffix_automaton.hpp>
 #include <step20/suffix_tree.hpp>
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
 
 using namespace step20;
 using namespace std::literals;
@@ -68,6 +89,62 @@ struct less {
 
 }  // namespace case_insensitive
 
+void test_adaptive_replacement_hello_world()
+{
+    log("run");
+    auto arc = adaptive_replacement::cache<int, int>(2);
+    arc.insert_or_assign(1, 1);
+    arc.insert_or_assign(2, 2);
+    check(*arc.find(1) == 1);
+    arc.insert_or_assign(3, 3);
+    check(arc.find(2) == nullptr);
+    arc.insert_or_assign(4, 4);
+    check(*arc.find(1) == 1);
+    check(arc.find(3) == nullptr);
+    check(*arc.find(4) == 4);
+}
+
+void test_adaptive_replacement_scan()
+{
+    log("run");
+    constexpr int capacity = 100;
+    auto arc = adaptive_replacement::cache<int, int>(capacity);
+    auto lru = least_recently_used::cache<int, int>(capacity);
+    auto arc_hits = 0, lru_hits = 0, key = capacity;
+    auto access = [&](int key) {
+        arc_hits += !!arc.find(key);
+        lru_hits += !!lru.find(key);
+        arc.insert_or_assign(key, key);
+        lru.insert_or_assign(key, key);
+    };
+    for (int i = 0; i < 100; ++i) {
+        for (int hot = 0; hot < capacity * 3 / 2; ++hot)
+            access(hot % (capacity * 3 / 4));
+        for (int j = 0; j < capacity * 2; ++j)
+            access(key++);
+    }
+    check(arc_hits > lru_hits * 3 / 2);
+}
+
+void test_count_min_sketch()
+{
+    log("run");
+    for (int shift : {0, 20, 32}) {  ///< keys differ in high bits only
+        auto sketch = count_min_sketch(256);
+        auto hash = [&](int key) {
+            return std::hash<uint64_t>{}(uint64_t(key) << shift);
+        };
+        for (int key = 0; key < 500; ++key)
+            sketch.add(hash(key));
+        int over = 0, fresh = 0;  ///< about 12 with independent rows
+        for (int key = 0; key < 500; ++key) {
+            over += sketch.estimate(hash(key)) > 1;
+            fresh += sketch.estimate(hash(key + 500)) > 0;
+        }
+        check(over < 50 && fresh < 50);
+    }
+}
+
 void test_edit_distance_case_insensitive()
 {
     log("run");
@@ -130,6 +207,86 @@ void test_edit_distance_case_insensitive()
     }
 }
 
+void test_edit_distance_cigar()
+{
+    log("run");
+    using edit_distance::operation;
+    auto result = std::vector<edit_distance::run_type>{};
+    edit_distance::cigar("GCGTATGAGGCTAACGC"sv,
+                         "GCTATGCGGCTATACGC"sv,
+                         std::back_inserter(result));
+    check(result == std::vector<edit_distance::run_type>{
+                        {operation::match, 2, 0, 0},
+                        {operation::deletion, 1, 2, 2},
+                        {operation::match, 4, 3, 2},
+                        {operation::mismatch, 1, 7, 6},
+                        {operation::match, 5, 8, 7},
+                        {operation::insertion, 1, 13, 12},
+                        {operation::match, 4, 13, 13},
+                    });
+    for (std::size_t len = 0; len < 50; ++len) {
+        auto lhs = generate_random_string(len);
+        auto rhs = generate_random_string(len * 2 / 3);
+        auto pairs = maybe_char_pairs{};
+        edit_distance::zip(lhs, rhs, std::back_inserter(pairs));
+        auto runs = std::vector<edit_distance::run_type>{};
+        edit_distance::cigar(lhs, rhs, std::back_inserter(runs));
+        auto it = pairs.begin();
+        auto pos1 = std::size_t{}, pos2 = std::size_t{};
+        for (auto& run : runs) {
+            check(run.length > 0 && run.pos1 == pos1 && run.pos2 == pos2);
+            for (std::size_t i = 0; i < run.length; ++i, ++it) {
+                auto& [l, r] = *it;
+                if (run.op == operation::insertion)
+                    check(!l && r == rhs[pos2++]);
+                else if (run.op == operation::deletion)
+                    check(l == lhs[pos1++] && !r);
+                else
+                    check(l == lhs[pos1++] && r == rhs[pos2++] &&
+                          (*l == *r) == (run.op == operation::match));
+            }
+        }
+        check(it == pairs.end());
+    }
+}
+
+std::size_t levenshtein(std::string_view lhs, std::string_view rhs)
+{
+    auto row = std::vector<std::size_t>(rhs.size() + 1);
+    std::iota(row.begin(), row.end(), 0);
+    for (std::size_t l = 1; l <= lhs.size(); ++l) {
+        auto diag = std::exchange(row[0], l);
+        for (std::size_t r = 1; r <= rhs.size(); ++r)
+            diag = std::exchange(row[r],
+                                 std::min({row[r] + 1,
+                                           row[r - 1] + 1,
+                                           diag + (lhs[l - 1] != rhs[r - 1])}));
+    }
+    return row.back();
+}
+
+void test_edit_distance_distances()
+{
+    log("run");
+    auto strs = std::vector<std::string>{};
+    for (std::size_t len : {0, 1, 7, 63, 64, 65, 150, 200})
+        for (int i = 0; i < 3; ++i)
+            strs.push_back(generate_random_string(len));
+    strs.push_back(strs.back());
+    strs.back().insert(77, "inserted");
+    auto matrix = edit_distance::distances(strs);
+    for (std::size_t i = 0; i < strs.size(); ++i) {
+        auto row = edit_distance::distances(strs[i], strs, 100);
+        for (std::size_t j = 0; j < strs.size(); ++j) {
+            auto expect = levenshtein(strs[i], strs[j]);
+            check(matrix[i * strs.size() + j] == expect);
+            check(edit_distance::distance(strs[i], strs[j]) == expect);
+            check(row[j] ==
+                  (expect > 100 ? std::nullopt : std::optional{expect}));
+        }
+    }
+}
+
 void test_edit_distance_hello_world()
 {
     log("run");
@@ -143,6 +300,28 @@ void test_edit_distance_hello_world()
                     });
 }
 
+void test_example_cache_sim()
+{
+    log("run");
+    auto trace = cache_sim::parse_text("a\nb\r\na\nc\nb\n");
+    check(trace == cache_sim::trace_t{0, 1, 0, 2, 1});
+    auto bin = std::string_view(reinterpret_cast<const char*>(trace.data()),
+                                trace.size() * sizeof(cache_sim::key_type));
+    check(cache_sim::parse_binary(bin) == trace);
+    auto reports = cache_sim::sweep(trace, {1, 2});
+    check(reports.size() == cache_sim::policies.size() * 2);
+    for (auto& rep : reports) {
+        check(rep.ops == trace.size() && rep.hits <= 2);
+        if (rep.policy == "LRU")
+            check(rep.hits == (rep.capacity == 1 ? 0 : 1));
+    }
+    auto zipf = cache_sim::generate(2000, 100);
+    check(zipf.size() == 2000 && zipf == cache_sim::generate(2000, 100));
+    check(std::ranges::count_if(zipf, [](auto key) { return key < 100; }) ==
+          1800);
+    check(std::ranges::count(zipf, 0) > std::ranges::count(zipf, 99));
+}
+
 void test_example_diff()
 {
     log("run");
@@ -169,10 +348,33 @@ void test_example_diff()
 +to this document.
 )"sv;
     auto result = std::ostringstream{};
-    diff::dump(read_file("../example/diff/file1.txt"),
-               read_file("../example/diff/file2.txt"),
+    diff::dump(file_view("../example/diff/file1.txt"),
+               file_view("../example/diff/file2.txt"),
                result);
     check(result.str() == expect);
+#if !defined(_WIN32)
+    int fds[2];  ///< pipe is read like process substitution
+    check(::pipe(fds) == 0);
+    auto file2 = file_view("../example/diff/file2.txt");
+    check(::write(fds[1], file2.data(), file2.size()) == (long)file2.size());
+    ::close(fds[1]);
+    auto piped = file_view(("/dev/fd/" + std::to_string(fds[0])).c_str());
+    ::close(fds[0]);
+    result.str({});
+    diff::dump(file_view("../example/diff/file1.txt"), piped, result);
+    check(result.str() == expect);
+#endif
+    result.str({});
+    diff::dump("a\nb\nc\nd\ne\nz"sv, "e\ny"sv, result);
+    check(result.str() == R"(@@ -1,4 +1,0 @@
+-a
+-b
+-c
+-d
+@@ -6,1 +2,1 @@
+-z
++y
+)"sv);
 }
 
 void test_example_suffix_tree_viz()
@@ -272,6 +474,166 @@ _1->0 [label="bxa$"]
     }
 }
 
+struct test_clock {
+    using duration = std::chrono::milliseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<test_clock>;
+    static constexpr bool is_steady = true;
+    static inline time_point current{};
+    static time_point now() { return current; }
+};
+
+void test_expiring_cache()
+{
+    log("run");
+    auto cache = expiring_cache<int,
+                                int,
+                                least_frequently_used::cache,
+                                std::hash<int>,
+                                std::equal_to<int>,
+                                test_clock>(100, 10ms);
+    cache.insert_or_assign(1, 1);
+    cache.insert_or_assign(2, 2, 1h);
+    test_clock::current += 9ms;
+    check(*cache.find(1) == 1);
+    cache.insert_or_assign(3, 3);
+    test_clock::current += 1ms;
+    check(!cache.find(1) && *cache.find(2) == 2);
+    cache.insert_or_assign(3, 3, 2h);
+    test_clock::current += 1h;
+    check(!cache.find(2) && *cache.find(3) == 3 && cache.size() == 1);
+    for (int i = 0; i < 1000; ++i)
+        cache.insert_or_assign(3, i, 1ms + i * 1ms);
+    check(cache.size() == 1 && cache.timers() == 1);
+    for (int key = 0; key < 1000; ++key)
+        cache.insert_or_assign(key, key, 1h);
+    check(cache.size() == 100 && cache.timers() == 100);
+    check(cache.erase(999) && cache.timers() == 99);
+    test_clock::current += 1h;
+    check(!cache.find(998) && cache.size() == 0 && cache.timers() == 0);
+    auto stats = expiring_cache<int,
+                                int,
+                                least_recently_used::cache,
+                                std::hash<int>,
+                                std::equal_to<int>,
+                                test_clock,
+                                statistics<>>(1, 10ms);
+    stats.insert_or_assign(1, 1);
+    stats.insert_or_assign(2, 2);  ///< evicts 1
+    check(stats.erase(2) && !stats.find(2));
+    stats.insert_or_assign(3, 3);
+    check(*stats.find(3) == 3);
+    test_clock::current += 10ms;
+    check(!stats.find(3) && stats.size() == 0 && stats.timers() == 0);
+    auto& observer = stats.observer();
+    check(observer.hits == 1 && observer.misses == 2 &&
+          observer.evictions == 2 && observer.erasures == 1);
+}
+
+generator<int, std::pmr::polymorphic_allocator<>> iota(
+    std::allocator_arg_t,
+    std::pmr::polymorphic_allocator<>,
+    int n)
+{
+    for (int i = 0; i < n; ++i)
+        co_yield i;
+}
+
+void test_generator_allocator()
+{
+    log("run");
+    struct counting_resource : std::pmr::memory_resource {
+        int allocations = 0;
+        int deallocations = 0;
+
+        void* do_allocate(std::size_t bytes, std::size_t align) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, align);
+        }
+
+        void do_deallocate(void* ptr,
+                           std::size_t bytes,
+                           std::size_t align) override
+        {
+            ++deallocations;
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, align);
+        }
+
+        bool do_is_equal(const memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+    auto resource = counting_resource{};
+    for (int n = 0; n < 3; ++n)
+        check(std::ranges::equal(iota(std::allocator_arg, &resource, n),
+                                 std::views::iota(0, n)));
+    check(resource.allocations == 3 && resource.deallocations == 3);
+    auto alloc = pool_allocator<std::byte>{};
+    auto ptr = alloc.allocate(100);
+    alloc.deallocate(ptr, 100);
+    check(alloc.allocate(90) == ptr);
+    alloc.deallocate(ptr, 90);
+    std::thread([] {
+        struct holder {  ///< outlives the pool of the thread
+            std::byte* ptr = nullptr;
+            ~holder() { pool_allocator<std::byte>{}.deallocate(ptr, 100); }
+        };
+        thread_local auto block = holder{};
+        block.ptr = pool_allocator<std::byte>{}.allocate(100);
+    }).join();
+}
+
+generator<int> countdown(int n)
+{
+    if (n < 0)
+        throw std::out_of_range("countdown");
+    if (n == 0)
+        co_return;
+    co_yield n;
+    co_yield elements_of(countdown(n - 1));
+}
+
+generator<int> preorder(int node, int size)
+{
+    co_yield node;
+    for (auto child : {2 * node + 1, 2 * node + 2})
+        if (child < size)
+            co_yield elements_of(preorder(child, size));
+}
+
+generator<int> throwing()
+{
+    co_yield 1;
+    co_yield elements_of(countdown(-1));
+}
+
+void test_generator_elements_of()
+{
+    log("run");
+    check(std::ranges::equal(countdown(10000),
+                             std::views::iota(1, 10001) | std::views::reverse));
+    check(std::ranges::equal(preorder(0, 7),
+                             std::vector{0, 1, 3, 4, 2, 5, 6}));
+    auto flat = [](std::vector<int> vec) -> generator<int> {
+        co_yield 0;
+        co_yield elements_of(vec);
+    };
+    check(std::ranges::equal(flat({1, 2}), std::vector{0, 1, 2}));
+    auto gen = throwing();
+    auto it = gen.begin();
+    check(*it == 1);
+    try {
+        ++it;
+        check(false);
+    }
+    catch (const std::out_of_range&) {
+        check(it == gen.end());
+    }
+}
+
 void test_least_frequently_used_hello_world()
 {
     log("run");
@@ -303,6 +665,418 @@ void test_least_recently_used_hello_world()
     check(*lru.find(4) == 4);
 }
 
+template <template <class...> class Cache>
+void test_least_recently_used_zero_capacity()
+{
+    log("run");
+    auto lru = Cache<int, int>(0);
+    lru.insert_or_assign(1, 1);
+    check(lru.size() == 0 && !lru.find(1));
+    if constexpr (requires { lru.try_emplace(2, 2); }) {
+        check(!lru.try_emplace(2, 2));
+        check(!lru.find(2));
+        check(lru.get_or_insert_with(3, [] { return 3; }) == 3);
+    }
+    lru.insert_or_assign(4, 4);
+    check(lru.size() == 0);
+}
+
+void test_least_frequently_used_aging()
+{
+    log("run");
+    for (bool aging : {false, true}) {
+        auto lfu = least_frequently_used::cache<int, int>(2, aging);
+        lfu.insert_or_assign(0, 0);
+        for (int i = 0; i < 100; ++i)
+            check(*lfu.find(0) == 0);
+        for (int key = 1; key < 300; ++key) {
+            lfu.insert_or_assign(key, key);
+            check(*lfu.find(key) == key);
+        }
+        check(!lfu.find(0) == aging);
+    }
+}
+
+void test_least_frequently_used_statistics()
+{
+    log("run");
+    struct observer : statistics<> {
+        std::vector<int> evicted;
+        void on_evict(int key, int val)
+        {
+            statistics::on_evict(key, val);
+            evicted.push_back(key);
+        }
+    };
+    using hash_t = std::hash<int>;
+    using eq_t = std::equal_to<int>;
+    auto lfu = least_frequently_used::
+        cache<int, int, hash_t, eq_t, unit_weigher, observer>(2);
+    lfu.insert_or_assign(1, 1);
+    lfu.insert_or_assign(2, 2);
+    lfu.find(1);
+    lfu.find(1);
+    lfu.find(3);
+    lfu.insert_or_assign(3, 3);
+    auto& stats = lfu.observer();
+    check(stats.hits == 2 && stats.misses == 1 && stats.evictions == 1);
+    check(stats.evicted == std::vector{2});
+    check(lfu.frequency_histogram() ==
+          std::vector<std::pair<std::size_t, std::size_t>>{{1, 1}, {3, 1}});
+}
+
+void test_least_frequently_used_snapshot()
+{
+    log("run");
+    struct text_codec {  ///< user-supplied codec
+        static void encode(std::ostream& os, int val) { os << val << ' '; }
+        static int decode(std::istream& is)
+        {
+            int result;
+            is >> result;
+            is.get();
+            return result;
+        }
+    };
+    auto lfu = least_frequently_used::cache<int, std::string>(4);
+    for (int key : {1, 2, 2, 3, 3, 3, 4, 4, 4, 4}) {
+        lfu.insert_or_assign(key, std::to_string(key));
+        lfu.find(key);
+    }
+    auto ss = std::stringstream{};
+    lfu.save(ss, text_codec{});
+    auto copy = least_frequently_used::cache<int, std::string>(4);
+    copy.load(ss, text_codec{});
+    check(copy.frequency_histogram() == lfu.frequency_histogram());
+    check(*copy.victim() == 1 && *copy.peek(4) == "4");
+    ss.seekg(0);
+    auto hot = least_frequently_used::cache<int, std::string>(2);
+    hot.load(ss, text_codec{});
+    check(hot.size() == 2 && hot.peek(3) && hot.peek(4));
+    auto aged = least_frequently_used::cache<int, std::string>(8, true);
+    for (int key = 10; key < 40; ++key) {
+        aged.insert_or_assign(key, std::to_string(key));
+        for (int i = 0; i < key % 7; ++i)
+            aged.find(key);
+    }
+    for (int key = 30; key < 40; ++key)
+        aged.erase(key);
+    check(aged.size() == 1 && *aged.victim() == 27);
+    ss.seekg(0);
+    aged.load(ss, text_codec{});  ///< loaded items do not fall behind age
+    check(aged.size() == 5 && *aged.victim() == 27);
+    for (int key = 40; key < 50; ++key) {
+        auto hist = aged.frequency_histogram();
+        auto freqs = hist | std::views::keys;
+        check(std::ranges::adjacent_find(freqs, std::greater_equal{}) ==
+              freqs.end());
+        auto victim = *aged.victim();
+        auto full = aged.size() == 8;
+        aged.insert_or_assign(key, std::to_string(key));
+        check(!aged.peek(victim) == full && aged.peek(key));
+    }
+}
+
+void test_least_frequently_used_tiny_cache()
+{
+    log("run");
+    constexpr int capacity = 100, hot = capacity / 2;
+    auto lfu = least_frequently_used::tiny_cache<int, int>(capacity);
+    auto access = [&](int key) {
+        if (!lfu.find(key))
+            lfu.insert_or_assign(key, key);
+    };
+    for (int i = 0; i < capacity * 100; ++i) {
+        access(i % hot);
+        access(capacity + i);  ///< one-hit wonders
+    }
+    check(lfu.size() == capacity);
+    int hits = 0;
+    for (int key = 0; key < hot; ++key)
+        if (auto val = lfu.find(key))
+            hits += *val == key;
+    check(hits == hot);
+    lfu = least_frequently_used::tiny_cache<int, int>(capacity);
+    for (int key = 0; key < capacity; ++key)
+        access(key);
+    for (int key = 0; key + 1 < capacity; ++key)
+        check(*lfu.find(key) == key);
+    for (int i = 0; i < 10; ++i)  ///< writes are not accesses
+        lfu.insert_or_assign(capacity - 1, i);
+    lfu.insert_or_assign(capacity, capacity);
+    check(!lfu.find(capacity - 1));
+}
+
+struct string_hash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view str) const
+    {
+        return std::hash<std::string_view>{}(str);
+    }
+};
+
+template <template <class...> class Cache>
+void test_cache_emplace()
+{
+    log("run");
+    using ptr_t = std::unique_ptr<int>;
+    auto cache = Cache<std::string, ptr_t, string_hash, std::equal_to<>>(2);
+    auto calls = 0;
+    auto factory = [&] { return std::make_unique<int>(++calls); };
+    check(*cache.get_or_insert_with("one"sv, factory) == 1);
+    check(*cache.get_or_insert_with("one"sv, factory) == 1);
+    check(calls == 1);
+    auto val = std::make_unique<int>(2);
+    check(cache.try_emplace("two"s, std::move(val)));
+    check(!val && **cache.find("two"sv) == 2);
+    val = std::make_unique<int>(3);
+    check(!cache.try_emplace("two"s, std::move(val)));
+    check(val && **cache.find("two"sv) == 2);
+    cache.insert_or_assign("two"sv, std::move(val));
+    check(!val && **cache.find("two"sv) == 3);
+    cache.insert_or_assign("three"s, std::make_unique<int>(4));
+    check(!cache.find("one"sv) && **cache.find("three"sv) == 4);
+    auto any = Cache<int, std::any>(2);  ///< constructible from anything
+    check(std::any_cast<int>(any.get_or_insert_with(1, [] { return 1; })) == 1);
+    check(std::any_cast<int>(any.get_or_insert_with(1, [] { return 2; })) == 1);
+}
+
+struct size_weigher {
+    std::size_t operator()(int, const std::string& str) const
+    {
+        return str.size();
+    }
+};
+
+template <class Cache>
+void check_cache_weigher(Cache cache)  ///< capacity 10, max weight 8
+{
+    cache.insert_or_assign(1, "1111"s);
+    cache.insert_or_assign(2, "2222"s);
+    check(cache.size() == 2 && cache.weight() == 8);
+    cache.insert_or_assign(3, "333"s);
+    check(!cache.find(1) && cache.weight() == 7);
+    check(!cache.try_emplace(4, "444444444"s) && !cache.find(4));
+    cache.insert_or_assign(3, "3333333"s);
+    check(!cache.find(2) && cache.size() == 1 && cache.weight() == 7);
+    cache.insert_or_assign(3, "333333333"s);
+    check(!cache.find(3) && cache.size() == 0 && cache.weight() == 0);
+}
+
+void test_cache_weigher()
+{
+    log("run");
+    using namespace least_recently_used;
+    using hash_t = std::hash<int>;
+    using eq_t = std::equal_to<int>;
+    using lfu_t = least_frequently_used::
+        cache<int, std::string, hash_t, eq_t, size_weigher>;
+    using lru_t = cache<int, std::string, hash_t, eq_t, size_weigher>;
+    using flat_t = flat_cache<int, std::string, hash_t, eq_t, size_weigher>;
+    check_cache_weigher(lfu_t(10, false, 8));
+    check_cache_weigher(lru_t(10, 8));
+    check_cache_weigher(flat_t(10, 8));
+}
+
+void test_least_recently_used_clock_cache()
+{
+    log("run");
+    auto lru = least_recently_used::clock_cache<int, int>(2);
+    lru.insert_or_assign(1, 1);
+    lru.insert_or_assign(2, 2);
+    check(*lru.find(1) == 1);
+    lru.insert_or_assign(3, 3);
+    check(lru.find(2) == nullptr);
+    lru.insert_or_assign(4, 4);
+    check(lru.find(1) == nullptr);
+    check(*lru.find(3) == 3);
+    check(*lru.find(4) == 4);
+}
+
+template <class Cache>
+void check_cache_find_many(Cache cache)  ///< capacity 10
+{
+    auto items = std::vector<std::pair<int, int>>{};
+    for (int key = 0; key < 20; ++key)
+        items.emplace_back(key, -key);
+    cache.insert_many(items);
+    auto keys = std::vector<int>{};
+    for (int key = 20; key-- > 0;)
+        keys.push_back(key);
+    auto expect = std::vector<const int*>{};
+    for (auto key : keys)
+        expect.push_back(cache.peek(key));
+    auto vals = std::vector<const int*>{};
+    cache.find_many(keys, std::back_inserter(vals));
+    check(vals == expect);
+    check(std::ranges::count(vals, nullptr) == 10);
+}
+
+void test_cache_find_many()
+{
+    log("run");
+    check_cache_find_many(least_frequently_used::cache<int, int>(10));
+    check_cache_find_many(least_recently_used::cache<int, int>(10));
+    check_cache_find_many(least_recently_used::flat_cache<int, int>(10));
+}
+
+template <class Cache>
+void check_cache_insert_many(Cache cache)  ///< capacity 10
+{
+    auto items = std::vector<std::pair<int, std::unique_ptr<int>>>{};
+    for (int key = 0; key < 20; ++key)
+        items.emplace_back(key, std::make_unique<int>(-key));
+    cache.insert_many(std::move(items));
+    check(!cache.find(9));
+    for (int key = 10; key < 20; ++key)
+        check(**cache.find(key) == -key);
+}
+
+void test_cache_insert_many()
+{
+    log("run");
+    using ptr_t = std::unique_ptr<int>;
+    check_cache_insert_many(least_frequently_used::cache<int, ptr_t>(10));
+    check_cache_insert_many(least_recently_used::cache<int, ptr_t>(10));
+    check_cache_insert_many(least_recently_used::flat_cache<int, ptr_t>(10));
+}
+
+template <template <class...> class Cache>
+void test_least_recently_used_snapshot()
+{
+    log("run");
+    auto lru = Cache<std::string, int>(3);
+    for (auto key : {"a", "b", "c", "d"})
+        lru.insert_or_assign(key, (int)lru.size());
+    lru.find("b");
+    auto ss = std::stringstream{};
+    lru.save(ss);
+    auto copy = Cache<std::string, int>(3);
+    copy.load(ss);
+    copy.insert_or_assign("e", 3);
+    check(!copy.peek("c") && *copy.peek("d") == 3 && *copy.peek("b") == 1);
+    ss.seekg(0);
+    auto hot = Cache<std::string, int>(1);
+    hot.load(ss);
+    check(hot.size() == 1 && *hot.peek("b") == 1);
+    ss.str(ss.str().substr(0, ss.str().size() - 1));
+    try {
+        Cache<std::string, int>(3).load(ss);
+        check(false);
+    }
+    catch (const std::ios_base::failure&) {
+    }
+    ss = std::stringstream{};
+    codec<uint64_t>::encode(ss, 1);           ///< items
+    codec<uint64_t>::encode(ss, 1ull << 60);  ///< corrupt key length
+    ss << "abc";
+    try {
+        Cache<std::string, int>(3).load(ss);
+        check(false);
+    }
+    catch (const std::ios_base::failure&) {
+    }
+}
+
+void test_least_recently_used_statistics()
+{
+    log("run");
+    using hash_t = std::hash<int>;
+    using eq_t = std::equal_to<int>;
+    using stats_t = statistics<std::atomic_size_t>;
+    auto lru = least_recently_used::
+        cache<int, int, hash_t, eq_t, unit_weigher, stats_t>(2);
+    for (int key : {1, 2, 1, 3, 1, 2})
+        lru.get_or_insert_with(key, [=] { return key; });
+    auto& stats = lru.observer();
+    check(stats.hits == 2 && stats.misses == 4 && stats.evictions == 2);
+    check(stats.hit_ratio() == 2. / 6);
+    check(lru.erase(2) && !lru.erase(2) && stats.erasures == 1);
+}
+
+void test_least_recently_used_flat_cache()
+{
+    log("run");
+    static auto gen = std::mt19937{std::random_device{}()};
+    auto dist = std::uniform_int_distribution{0, 99};
+    for (std::size_t capacity : {1, 2, 10, 50}) {
+        auto expect = least_recently_used::cache<int, int>(capacity);
+        auto flat = least_recently_used::flat_cache<int, int>(capacity);
+        for (int i = 0; i < 10000; ++i) {
+            auto key = dist(gen);
+            if (i % 3) {
+                auto lhs = expect.find(key);
+                auto rhs = flat.find(key);
+                check(lhs ? rhs && *lhs == *rhs : !rhs);
+            }
+            else {
+                expect.insert_or_assign(key, i);
+                flat.insert_or_assign(key, i);
+            }
+        }
+    }
+}
+
+void test_loading_cache()
+{
+    log("run");
+    auto calls = std::atomic_int{};
+    auto loader = [&](int key) {
+        ++calls;
+        std::this_thread::sleep_for(10ms);
+        if (key < 0)
+            throw std::invalid_argument("negative");
+        return key * 2;
+    };
+    using cache_t = least_recently_used::cache<int, int>;
+    auto cache = loading_cache<cache_t, decltype(loader), test_clock>(
+        10, loader, 1min);
+    parallel_for(8, [&](std::size_t) { check(cache.get(1) == 2); });
+    check(calls == 1);
+    auto failures = std::atomic_int{};
+    parallel_for(8, [&](std::size_t) {
+        try {
+            cache.get(-1);
+        }
+        catch (const std::invalid_argument&) {
+            ++failures;
+        }
+    });
+    check(calls == 2 && failures == 8);
+    test_clock::current += 1min;
+    check(cache.get(1) == 2 && calls == 2);
+    try {
+        cache.get(-1);
+    }
+    catch (const std::invalid_argument&) {
+        ++failures;
+    }
+    check(calls == 3 && failures == 9);
+    struct throwing_weigher {
+        std::size_t operator()(int, int val) const
+        {
+            if (val == 42)
+                throw std::length_error("weigh");
+            return 1;
+        }
+    };
+    using weighed_t = least_recently_used::
+        cache<int, int, std::hash<int>, std::equal_to<int>, throwing_weigher>;
+    auto weighed = loading_cache<weighed_t, decltype(loader), test_clock>(
+        10, loader, 1min);
+    auto values = std::atomic_int{};
+    auto errors = std::atomic_int{};
+    parallel_for(8, [&](std::size_t) {
+        try {
+            values += weighed.get(21) == 42;
+        }
+        catch (const std::length_error&) {
+            ++errors;
+        }
+    });
+    check(values + errors == 8 && errors > 0);
+}
+
 void test_longest_common_subsequence_case_insensitive()
 {
     log("run");
@@ -326,6 +1100,58 @@ void test_longest_common_subsequence_case_insensitive()
     }
 }
 
+void test_longest_common_subsequence_diff()
+{
+    log("run");
+    for (std::size_t len = 0; len < 100; ++len) {
+        auto lhs = generate_random_string(len);
+        auto rhs = generate_random_string(len / 2);
+        for (std::size_t i = 0; i < rhs.size(); i += 3)
+            rhs[i] = lhs[i];
+        using range_t = std::ranges::subrange<std::string::const_iterator>;
+        auto hunks = std::vector<std::pair<range_t, range_t>>{};
+        longest_common_subsequence::diff(lhs, rhs, std::back_inserter(hunks));
+        auto common1 = std::string{}, common2 = std::string{};
+        auto first1 = lhs.cbegin(), first2 = rhs.cbegin();
+        for (auto& [r1, r2] : hunks) {
+            check(!r1.empty() || !r2.empty());
+            common1.append(first1, r1.begin());
+            common2.append(first2, r2.begin());
+            first1 = r1.end();
+            first2 = r2.end();
+        }
+        common1.append(first1, lhs.cend());
+        common2.append(first2, rhs.cend());
+        auto expect = std::string{};
+        longest_common_subsequence::copy(lhs, rhs, std::back_inserter(expect));
+        check(common1 == common2);
+        check(common1.size() == expect.size());
+    }
+}
+
+void test_longest_common_subsequence_lengths()
+{
+    log("run");
+    auto strs = std::vector<std::string>{};
+    for (std::size_t len : {0, 1, 7, 63, 64, 65, 150, 200})
+        for (int i = 0; i < 3; ++i)
+            strs.push_back(generate_random_string(len));
+    auto matrix = longest_common_subsequence::lengths(strs);
+    for (std::size_t i = 0; i < strs.size(); ++i) {
+        auto row = longest_common_subsequence::lengths(strs[i], strs, 50);
+        for (std::size_t j = 0; j < strs.size(); ++j) {
+            auto str = std::string{};
+            longest_common_subsequence::copy(
+                strs[i], strs[j], std::back_inserter(str));
+            check(matrix[i * strs.size() + j] == str.size());
+            check(longest_common_subsequence::length(strs[i], strs[j]) ==
+                  str.size());
+            check(row[j] == (str.size() < 50 ? std::nullopt
+                                             : std::optional{str.size()}));
+        }
+    }
+}
+
 void test_longest_common_subsequence_hello_world()
 {
     log("run");
@@ -345,6 +1171,13 @@ void test_longest_common_substring_case_insensitive()
                                    std::back_inserter(result),
                                    case_insensitive::less{});
     check(result == "Geeks"sv);
+    using map_t = std::map<char, std::size_t, case_insensitive::less>;
+    auto dawg = to<suffix_automaton<char, std::size_t, map_t>>(
+        "geeksforGeeks"sv);
+    result.clear();
+    longest_common_substring::copy(
+        dawg, "GEEKSQUIZ"sv, std::back_inserter(result));
+    check(result == "geeks"sv);
 }
 
 void test_longest_common_substring_hello_world()
@@ -376,6 +1209,15 @@ void test_longest_common_substring_find()
         auto result = std::string{};
         longest_common_substring::copy(lhs, rhs, std::back_inserter(result));
         check(expect == result);
+        auto dawg = to<suffix_automaton>(lhs);
+        auto ss = std::istringstream{std::string{rhs}};
+        auto stream = std::ranges::subrange(std::istreambuf_iterator{ss},
+                                            std::istreambuf_iterator<char>{});
+        result.clear();
+        longest_common_substring::copy(
+            dawg, stream, std::back_inserter(result));
+        check(expect.size() == result.size() &&
+              lhs.find(result) != lhs.npos && rhs.find(result) != rhs.npos);
     }
 }
 
@@ -426,6 +1268,122 @@ void test_longest_repeated_substring_find()
     }
 }
 
+void test_maximal_repeats_hello_world()
+{
+    log("run");
+    auto arr = enhanced_suffix_array{"xabcyabcwabcyz"sv};
+    auto result = std::map<std::string_view, std::size_t>{};
+    maximal_repeats(arr, 2, std::inserter(result, result.end()));
+    check(result == decltype(result){{"abc", 3}, {"abcy", 2}});
+    result.clear();
+    supermaximal_repeats(arr, 1, std::inserter(result, result.end()));
+    check(result == decltype(result){{"abcy", 2}});
+}
+
+void test_maximal_repeats_cross_check()
+{
+    log("run");
+    using repeats_t = std::map<std::string_view, std::size_t>;
+    auto brute_force = [](std::string_view str) {
+        auto maximal = repeats_t{}, supermaximal = repeats_t{};
+        for (std::size_t len = 1; len < str.size(); ++len)
+            for (std::size_t pos = 0; pos + len <= str.size(); ++pos) {
+                auto sub = str.substr(pos, len);
+                auto left = std::set<int>{}, right = std::set<int>{};
+                std::size_t count = 0;
+                for (auto i = str.find(sub); i != str.npos;
+                     i = str.find(sub, i + 1), ++count) {
+                    left.insert(i ? str[i - 1] : -1 - (int)i);
+                    right.insert(i + len < str.size() ? str[i + len] : -2);
+                }
+                if (count > 1 && left.size() > 1 && right.size() > 1)
+                    maximal[sub] = count;
+            }
+        for (auto& [sub, count] : maximal)
+            if (std::ranges::none_of(maximal, [&](auto& other) {
+                    return other.first != sub &&
+                           other.first.find(sub) != sub.npos;
+                }))
+                supermaximal[sub] = count;
+        return std::pair{maximal, supermaximal};
+    };
+    static auto gen = std::mt19937{std::random_device{}()};
+    auto dist = std::uniform_int_distribution{'a', 'c'};
+    for (int n = 0; n < 40; ++n) {
+        auto str = std::string(n, 0);
+        std::ranges::generate(str, [&] { return dist(gen); });
+        auto arr = enhanced_suffix_array{str};
+        auto [maximal, supermaximal] = brute_force(str);
+        auto result = repeats_t{};
+        maximal_repeats(arr, 1, std::inserter(result, result.end()));
+        check(result == maximal);
+        result.clear();
+        supermaximal_repeats(arr, 1, std::inserter(result, result.end()));
+        check(result == supermaximal);
+    }
+}
+
+template <class Cache>
+void test_sharded_cache()
+{
+    log("run");
+    constexpr int keys = 1000;
+    auto cache = sharded_cache<Cache>(keys / 4, 8);
+    parallel_for(keys, [&](std::size_t) {
+        for (int key = 0; key < keys; ++key) {
+            if (auto val = cache.find(key))
+                check(*val == -key);
+            cache.insert_or_assign(key, -key);
+        }
+    });
+    int hits = 0;
+    for (int key = 0; key < keys; ++key)
+        hits += !!cache.find(key);
+    check(hits > 0 && hits <= keys / 4);
+    auto items = std::vector<std::pair<int, int>>{};
+    for (int key = keys; key < keys + 100; ++key)
+        items.emplace_back(key, -key);
+    cache.insert_many(items);
+    auto vals = cache.find_many(items | std::views::keys);
+    check(std::ranges::equal(vals, items | std::views::values, {}, [](auto v) {
+        return v.value_or(0);
+    }));
+    auto tiny = sharded_cache<Cache>(1, 8);  ///< seven shards are empty
+    for (int key = 0; key < keys; ++key)
+        tiny.insert_or_assign(key, key);
+    hits = 0;
+    for (int key = 0; key < keys; ++key)
+        hits += !!tiny.find(key);
+    check(hits == 1);
+}
+
+void test_sharded_cache_statistics()
+{
+    log("run");
+    using hash_t = std::hash<int>;
+    using eq_t = std::equal_to<int>;
+    using cache_t = least_recently_used::
+        cache<int, int, hash_t, eq_t, unit_weigher, statistics<>>;
+    auto cache = sharded_cache<cache_t>(4, 4);
+    for (int key = 0; key < 8; ++key)
+        if (!cache.find(key))
+            cache.insert_or_assign(key, key);
+    for (int key = 0; key < 8; ++key)
+        cache.erase(key);
+    auto stats = cache.stats();
+    check(stats.misses == 8 && stats.hits == 0);
+    check(stats.evictions + stats.erasures == 8 && stats.erasures > 0);
+}
+
+template <class Batches>
+auto join(Batches&& batches)
+{
+    auto result = std::vector<std::size_t>{};
+    for (auto batch : batches)
+        result.insert(result.end(), batch.begin(), batch.end());
+    return result;
+}
+
 void test_substring_search()
 {
     log("run");
@@ -471,6 +1429,43 @@ void test_substring_search()
             expect,
             to<std::vector>(
                 substring_search::find_all(tree, std::string{substr}))));
+        for (std::size_t batch_size : {0, 1, 2, 100}) {
+            check(std::ranges::is_permutation(
+                expect,
+                join(substring_search::find_all_batched(
+                    arr, std::string{substr}, batch_size))));
+            check(std::ranges::is_permutation(
+                expect,
+                join(substring_search::find_all_batched(
+                    tree, std::string{substr}, batch_size))));
+        }
+        for (auto batch :
+             substring_search::find_all_batched(arr, std::string{substr}, 0))
+            check(batch.size() == 1);
+        for (auto batch :
+             substring_search::find_all_batched(tree, std::string{substr}, 0))
+            check(batch.size() == 1);
+    }
+}
+
+void test_substring_search_file_view()
+{
+    log("run");
+    auto file = file_view("../example/diff/file2.txt");
+    auto txt = std::string_view{file};
+    auto arr =
+        suffix_array<char, uint32_t, std::less<>, std::string_view>{file};
+    auto tree = suffix_tree<char,
+                            uint32_t,
+                            std::unordered_map<char, uint32_t>,
+                            std::string_view>{file};
+    check(arr.data() == file.data() && tree.data() == file.data());
+    for (auto substr : {"important"sv, "document"sv, "not found"sv}) {
+        auto pos = txt.find(substr);
+        auto expect = pos == txt.npos ? std::nullopt : std::optional{pos};
+        check(substring_search::find_any(arr, substr).has_value() ==
+              expect.has_value());
+        check(substring_search::find_first(tree, substr) == expect);
     }
 }
 
@@ -489,6 +1484,30 @@ void test_suffix_array_lcp()
     check(std::ranges::equal(arr.lcp_array(), expect));
 }
 
+void test_suffix_array_compact_lcp()
+{
+    log("run");
+    static auto gen = std::mt19937{std::random_device{}()};
+    auto dist = std::uniform_int_distribution{'a', 'b'};
+    for (std::size_t n : {0, 1, 2, 100, 1000}) {
+        auto str = std::string(n, 0);
+        std::ranges::generate(str, [&] { return dist(gen); });
+        str += str.substr(0, n / 2);  ///< lcp overflows a byte
+        auto arr = enhanced_suffix_array{str};
+        auto lcp = arr.lcp_array();
+        auto txt = std::string_view{str};
+        for (std::size_t i = 0; i + 1 < arr.size(); ++i) {
+            auto diff = std::ranges::mismatch(txt.substr(arr[i]),
+                                              txt.substr(arr[i + 1]));
+            check(lcp[i] == diff.in1 - txt.begin() - arr[i]);
+        }
+        auto compact = compact_lcp_array{lcp};
+        check(compact.size() == lcp.size());
+        for (std::size_t i = 0; i < lcp.size(); ++i)
+            check(compact[i] == lcp[i]);
+    }
+}
+
 void test_suffix_array_n_tree_cross_check()
 {
     log("run");
@@ -503,6 +1522,110 @@ void test_suffix_array_n_tree_cross_check()
     check(std::cmp_equal(n, str.size()));
 }
 
+template <class Size>
+void check_suffix_array_child_table(std::string_view str)
+{
+    auto arr = child_table_suffix_array<char, Size>{str};
+    using interval_t = typename decltype(arr)::lcp_interval;
+    auto suffixes = std::vector<std::string_view>{};
+    for (std::size_t pos = 0; pos < str.size(); ++pos)
+        suffixes.push_back(str.substr(pos));
+    std::ranges::sort(suffixes);
+    /// LCP of ranks rank-1 and rank, -1 at the ends.
+    auto lcp = [&](std::size_t rank) {
+        if (rank == 0 || rank >= suffixes.size())
+            return std::ptrdiff_t{-1};
+        auto& lhs = suffixes[rank - 1];
+        auto& rhs = suffixes[rank];
+        return std::ranges::mismatch(lhs, rhs).in1 - lhs.begin();
+    };
+    auto expect = std::vector<std::tuple<std::size_t, std::size_t>>{};
+    for (std::size_t first = 0; first < suffixes.size(); ++first) {
+        auto height = std::numeric_limits<std::ptrdiff_t>::max();
+        for (auto last = first + 2; last <= suffixes.size(); ++last) {
+            height = std::min(height, lcp(last - 1));
+            if (height > 0 && lcp(first) < height && lcp(last) < height)
+                expect.emplace_back(first, last);
+        }
+    }
+    auto intervals = std::vector<std::tuple<std::size_t, std::size_t>>{};
+    auto stack = std::vector<interval_t>{arr.root()};
+    while (!stack.empty()) {
+        auto in = stack.back();
+        stack.pop_back();
+        auto children = std::vector<interval_t>{};
+        arr.children(in, std::back_inserter(children));
+        if (children.empty())
+            continue;
+        if (in.lcp > 0)
+            intervals.emplace_back(in.first, in.last);
+        check(children.front().first == in.first &&
+              children.back().last == in.last);
+        for (auto& child : children)
+            check(child.lcp > in.lcp ||  ///< suffix is a prefix of others
+                  (child.lcp == in.lcp && child.last - child.first == 1));
+        stack.insert(stack.end(), children.begin(), children.end());
+    }
+    check(std::ranges::is_permutation(intervals, expect));
+    for (std::size_t pos = 0; pos < str.size(); ++pos)
+        for (std::size_t len = 0; pos + len <= str.size(); ++len) {
+            auto substr = str.substr(pos, len);
+            auto found = to<std::vector<std::size_t>>(arr.find(substr));
+            auto brute = std::vector<std::size_t>{};
+            for (std::size_t i = 0; i < str.size(); ++i)
+                if (str.substr(i).starts_with(substr))
+                    brute.push_back(i);
+            check(std::ranges::is_permutation(found, brute));
+        }
+    check(arr.find("d"sv).empty());
+}
+
+void test_suffix_array_child_table()
+{
+    log("run");
+    static auto gen = std::mt19937{std::random_device{}()};
+    auto dist = std::uniform_int_distribution{'a', 'c'};
+    for (int n = 0; n < 100; ++n) {
+        auto str = std::string(n, 0);
+        std::ranges::generate(str, [&] { return dist(gen); });
+        check_suffix_array_child_table<std::size_t>(str);
+        check_suffix_array_child_table<std::uint32_t>(str);
+    }
+}
+
+void test_suffix_automaton_hello_world()
+{
+    log("run");
+    auto dawg = to<suffix_automaton>("banana"sv);
+    auto slice = dawg.find("ana"sv);
+    check(slice && slice->first == 1 && slice->last == 4);
+    check(!dawg.find("nab"sv));
+}
+
+void test_suffix_automaton_cross_check()
+{
+    log("run");
+    static auto gen = std::mt19937{std::random_device{}()};
+    auto dist = std::uniform_int_distribution{'a', 'c'};
+    for (int n = 0; n < 200; ++n) {
+        auto str = std::string(n, 0);
+        std::ranges::generate(str, [&] { return dist(gen); });
+        using map_t = std::map<char, uint16_t>;
+        auto dawg = suffix_automaton<char, uint16_t, map_t>{};
+        for (auto ch : str)
+            dawg.push_back(ch);
+        check(dawg.states() <= (std::size_t)std::max(2 * n - 1, n + 1));
+        for (std::size_t pos = 0; pos < str.size(); ++pos)
+            for (std::size_t len = 1; pos + len <= str.size(); len += 3) {
+                auto substr = std::string_view{str}.substr(pos, len);
+                auto slice = dawg.find(substr);
+                check(slice && slice->first == str.find(substr) &&
+                      slice->length() == len);
+            }
+        check(!dawg.find("d"sv));
+    }
+}
+
 void test_suffix_tree_hello_world()
 {
     log("run");
@@ -510,15 +1633,85 @@ void test_suffix_tree_hello_world()
     check(substring_search::find_first(tree, "text"sv) == 17);
 }
 
+void test_timer_wheel()
+{
+    log("run");
+    static auto gen = std::mt19937{std::random_device{}()};
+    for (uint64_t range : {10ull, 1000ull, 1ull << 20, 1ull << 40}) {
+        auto dist = std::uniform_int_distribution<uint64_t>{0, range};
+        uint64_t now = range;
+        auto wheel = timer_wheel<uint64_t>(now);
+        auto expect = std::multiset<uint64_t>{};
+        for (int i = 0; i < 1000; ++i) {
+            auto deadline = now + 1 + dist(gen);
+            wheel.schedule(deadline, deadline);
+            expect.insert(deadline);
+            if (i % 10)
+                continue;
+            now += dist(gen) / 10;
+            auto fired = std::multiset<uint64_t>{};
+            wheel.advance(now, [&](uint64_t val) { fired.insert(val); });
+            auto last = expect.upper_bound(now);
+            check(std::equal(expect.begin(), last, fired.begin(), fired.end()));
+            expect.erase(expect.begin(), last);
+            check(wheel.size() == expect.size());
+        }
+    }
+    auto wheel = timer_wheel<int>{};
+    auto timers = std::vector<timer_wheel<int>::handle>{};
+    for (int i = 0; i < 100; ++i)
+        timers.push_back(wheel.schedule(i * 100, i));
+    for (int i = 0; i < 100; i += 2)
+        wheel.cancel(timers[i]);
+    wheel.reschedule(timers[99], 50);
+    auto fired = std::vector<int>{};
+    wheel.advance(5000, [&](int val) { fired.push_back(val); });
+    auto expect = std::vector<int>{99};
+    for (int i = 1; i < 50; i += 2)
+        expect.push_back(i);
+    check(std::ranges::is_permutation(fired, expect) && wheel.size() == 24);
+}
+
 int main()
 {
+    test_adaptive_replacement_hello_world();
+    test_adaptive_replacement_scan();
+    test_count_min_sketch();
     test_edit_distance_case_insensitive();
+    test_edit_distance_cigar();
+    test_edit_distance_distances();
     test_edit_distance_hello_world();
+    test_example_cache_sim();
     test_example_diff();
     test_example_suffix_tree_viz();
+    test_expiring_cache();
+    test_generator_allocator();
+    test_generator_elements_of();
     test_least_frequently_used_hello_world();
+    test_least_frequently_used_aging();
+    test_least_frequently_used_statistics();
+    test_least_frequently_used_snapshot();
+    test_least_frequently_used_tiny_cache();
+    test_cache_emplace<least_frequently_used::cache>();
+    test_cache_emplace<least_recently_used::cache>();
+    test_cache_emplace<least_recently_used::flat_cache>();
+    test_cache_weigher();
+    test_least_recently_used_clock_cache();
+    test_cache_find_many();
+    test_cache_insert_many();
+    test_least_recently_used_snapshot<least_recently_used::cache>();
+    test_least_recently_used_snapshot<least_recently_used::flat_cache>();
+    test_least_recently_used_statistics();
+    test_least_recently_used_flat_cache();
     test_least_recently_used_hello_world();
+    test_least_recently_used_zero_capacity<least_recently_used::cache>();
+    test_least_recently_used_zero_capacity<
+        least_recently_used::flat_cache>();
+    test_least_recently_used_zero_capacity<adaptive_replacement::cache>();
+    test_loading_cache();
     test_longest_common_subsequence_case_insensitive();
+    test_longest_common_subsequence_diff();
+    test_longest_common_subsequence_lengths();
     test_longest_common_subsequence_hello_world();
     test_longest_common_substring_case_insensitive();
     test_longest_common_substring_hello_world();
@@ -526,10 +1719,21 @@ int main()
     test_longest_repeated_substring_case_insensitive();
     test_longest_repeated_substring_hello_world();
     test_longest_repeated_substring_find();
+    test_maximal_repeats_hello_world();
+    test_maximal_repeats_cross_check();
+    test_sharded_cache<least_recently_used::cache<int, int>>();
+    test_sharded_cache<least_recently_used::clock_cache<int, int>>();
+    test_sharded_cache_statistics();
     test_substring_search();
+    test_substring_search_file_view();
     test_suffix_array_hello_world();
     test_suffix_array_lcp();
+    test_suffix_array_compact_lcp();
     test_suffix_array_n_tree_cross_check();
+    test_suffix_array_child_table();
+    test_suffix_automaton_hello_world();
+    test_suffix_automaton_cross_check();
     test_suffix_tree_hello_world();
+    test_timer_wheel();
     log("done");
 }